@@ -7,11 +7,34 @@ INCLUDEPATH += $$PWD/src
 
 HEADERS += \
     $$PWD/src/QQmlObjectListModel.h \
+    $$PWD/src/QQmlPointerListModel.h \
     $$PWD/src/QQmlVariantListModel.h \
-    $$PWD/src/QQmlModelShared.h
+    $$PWD/src/QQmlModelShared.h \
+    $$PWD/src/QQmlObjectRoleTable.h \
+    $$PWD/src/QQmlModelRowIndex.h \
+    $$PWD/src/QQmlModelRowMap.h \
+    $$PWD/src/QQmlModelDataChangeQueue.h \
+    $$PWD/src/QQmlModelEditScript.h \
+    $$PWD/src/QQmlModelSort.h \
+    $$PWD/src/QQmlObjectListFilterModel.h \
+    $$PWD/src/QQmlPagedObjectListModel.h \
+    $$PWD/src/QQmlVectorListModel.h \
+    $$PWD/src/QQmlGadgetListModel.h \
+    $$PWD/src/QQmlStructListModel.h \
+    $$PWD/src/QQmlModelFeed.h \
+    $$PWD/src/QQmlModelSnapshot.h \
+    $$PWD/src/QQmlModelArchive.h \
+    $$PWD/src/QQmlModelJson.h \
+    $$PWD/src/QQmlValueListModel.h
 
 SOURCES += \
     $$PWD/src/QQmlObjectListModel.cpp \
     $$PWD/src/QQmlModelShared.cpp \
+    $$PWD/src/QQmlObjectRoleTable.cpp \
+    $$PWD/src/QQmlModelEditScript.cpp \
+    $$PWD/src/QQmlModelSort.cpp \
+    $$PWD/src/QQmlModelFeed.cpp \
+    $$PWD/src/QQmlModelArchive.cpp \
+    $$PWD/src/QQmlModelJson.cpp \
     $$PWD/src/QQmlVariantListModel.cpp
 
@@ -0,0 +1,204 @@
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QObject>
+#include <QString>
+#include <QtTest>
+
+#include <QQmlObjectListModel.h>
+#include <QQmlVariantListModel.h>
+
+#if defined (__GLIBC__)
+#   include <malloc.h>
+#endif
+
+QQMLMODEL_USING_NAMESPACE
+
+class BenchItem : public QObject {
+    Q_OBJECT
+    Q_PROPERTY (QString uid READ uid WRITE setUid NOTIFY uidChanged)
+    Q_PROPERTY (int value READ value WRITE setValue NOTIFY valueChanged)
+
+public:
+    explicit BenchItem (QObject * parent = Q_NULLPTR) : QObject (parent), m_value (0) { }
+
+    QString uid (void) const { return m_uid; }
+    int value (void) const { return m_value; }
+
+    void setUid (const QString & uid) {
+        if (m_uid != uid) {
+            m_uid = uid;
+            emit uidChanged ();
+        }
+    }
+    void setValue (int value) {
+        if (m_value != value) {
+            m_value = value;
+            emit valueChanged ();
+        }
+    }
+
+signals:
+    void uidChanged (void);
+    void valueChanged (void);
+
+private:
+    QString m_uid;
+    int     m_value;
+};
+
+typedef QQmlObjectListModel<BenchItem> BenchModel;
+
+static QList<BenchItem *> makeItems (int count) {
+    QList<BenchItem *> ret;
+    ret.reserve (count);
+    for (int idx = 0; idx < count; ++idx) {
+        BenchItem * item = new BenchItem;
+        item->setUid (QString::number (idx));
+        item->setValue (idx);
+        ret.append (item);
+    }
+    return ret;
+}
+
+/** Contents of a model of count items, saved with save () or writeJson () */
+static QByteArray savedItems (int count, bool json) {
+    BenchModel model;
+    model.append (makeItems (count));
+    QBuffer buffer;
+    buffer.open (QIODevice::WriteOnly);
+    if (json) {
+        model.writeJson (&buffer);
+    }
+    else {
+        model.save (&buffer);
+    }
+    return buffer.data ();
+}
+
+/** Contents of a variant model of count values, saved with save () or as a JSON array */
+static QByteArray savedValues (int count, bool json) {
+    QVariantList values;
+    values.reserve (count);
+    for (int idx = 0; idx < count; ++idx) {
+        values.append (QString::number (idx));
+    }
+    if (json) {
+        return QJsonDocument (QJsonArray::fromVariantList (values)).toJson (QJsonDocument::Compact);
+    }
+    QQmlVariantListModel model;
+    model.appendList (values);
+    QBuffer buffer;
+    buffer.open (QIODevice::WriteOnly);
+    model.save (&buffer);
+    return buffer.data ();
+}
+
+#if defined (__GLIBC__)
+/** Bytes of heap in use, as counted by the glibc allocator */
+static qint64 heapInUse (void) {
+#   if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+    return qint64 (mallinfo2 ().uordblks);
+#   else
+    return qint64 (mallinfo ().uordblks);
+#   endif
+}
+#endif
+
+static void addRestoreRows (void) {
+    QTest::addColumn<int> ("count");
+    QTest::addColumn<bool> ("json");
+    QTest::newRow ("10k archive") << 10000 << false;
+    QTest::newRow ("10k json") << 10000 << true;
+    QTest::newRow ("100k archive") << 100000 << false;
+    QTest::newRow ("100k json") << 100000 << true;
+}
+
+class QQmlModelBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void appendWithUid_data (void) {
+        QTest::addColumn<int> ("count");
+        QTest::newRow ("25k") << 25000;
+        QTest::newRow ("50k") << 50000;
+        QTest::newRow ("100k") << 100000; // linear : twice the time of 50k, a quadratic uid index would take four
+    }
+    void appendWithUid (void) {
+        QFETCH (int, count);
+        BenchModel model (Q_NULLPTR, QList<QByteArray> (), QByteArray (), QByteArrayLiteral ("uid"));
+        const QList<BenchItem *> items = makeItems (count);
+        QBENCHMARK_ONCE {
+            for (QList<BenchItem *>::const_iterator it = items.constBegin (); it != items.constEnd (); ++it) {
+                model.append (* it);
+            }
+        }
+        QCOMPARE (model.count (), count);
+        QCOMPARE (model.getByUid (QString::number (count -1)), items.last ());
+    }
+    void memoryPerItem_data (void) {
+        // one connection per distinct notify signal : the difference between the rows is the cost of a connection
+        QTest::addColumn<QList<QByteArray> > ("roles");
+        QTest::newRow ("100k, 1 notify signal") << (QList<QByteArray> () << QByteArrayLiteral ("value"));
+        QTest::newRow ("100k, 2 notify signals") << (QList<QByteArray> () << QByteArrayLiteral ("uid") << QByteArrayLiteral ("value"));
+    }
+    void memoryPerItem (void) {
+        // heap taken by the model for each item it references : connections, row index and list slot
+#if defined (__GLIBC__)
+        QFETCH (QList<QByteArray>, roles);
+        const int count = 100000;
+        const QList<BenchItem *> items = makeItems (count);
+        BenchModel model (Q_NULLPTR, roles);
+        const qint64 before = heapInUse ();
+        model.append (items);
+        const qint64 after = heapInUse ();
+        QCOMPARE (model.count (), count);
+        QTest::setBenchmarkResult (qreal (after - before) / count, QTest::BytesAllocated);
+#else
+        QSKIP ("Needs the heap statistics of the glibc allocator");
+#endif
+    }
+    void restoreObjects_data (void) {
+        addRestoreRows ();
+    }
+    void restoreObjects (void) {
+        // load () from a binary archive against appendFromJson () of the same items
+        QFETCH (int, count);
+        QFETCH (bool, json);
+        const QByteArray data = savedItems (count, json);
+        QBENCHMARK {
+            BenchModel model;
+            QBuffer buffer;
+            buffer.setData (data);
+            buffer.open (QIODevice::ReadOnly);
+            QVERIFY (json ? model.appendFromJson (&buffer) == count : model.load (&buffer));
+            QCOMPARE (model.count (), count);
+        }
+    }
+    void restoreValues_data (void) {
+        addRestoreRows ();
+    }
+    void restoreValues (void) {
+        // load () from a binary archive against parsing a JSON array and appending it
+        QFETCH (int, count);
+        QFETCH (bool, json);
+        const QByteArray data = savedValues (count, json);
+        QBENCHMARK {
+            QQmlVariantListModel model;
+            if (json) {
+                model.appendList (QJsonDocument::fromJson (data).array ().toVariantList ());
+            }
+            else {
+                QBuffer buffer;
+                buffer.setData (data);
+                buffer.open (QIODevice::ReadOnly);
+                QVERIFY (model.load (&buffer));
+            }
+            QCOMPARE (model.count (), count);
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN (QQmlModelBenchmark)
+
+#include "QQmlModelBenchmark.moc"
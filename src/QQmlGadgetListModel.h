@@ -0,0 +1,207 @@
+#ifndef QQMLGADGETLISTMODEL_H
+#define QQMLGADGETLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QVariant>
+#include <QVector>
+
+#include <algorithm>
+
+#include "QQmlModelShared.h"
+#include "QQmlObjectRoleTable.h"
+#include "QQmlVectorListModel.h"
+
+QQMLMODEL_NAMESPACE_START
+
+class QQmlGadgetListModelBase : public QAbstractListModel { // abstract Qt base class
+    Q_OBJECT
+    Q_PROPERTY (int count READ count NOTIFY countChanged)
+    Q_PROPERTY (int length READ count NOTIFY countChanged)
+
+public:
+    explicit QQmlGadgetListModelBase (QObject * parent = Q_NULLPTR) : QAbstractListModel (parent) { }
+
+public slots: // virtual methods API for QML
+	/** Returns the number of values in the list */
+	virtual int count (void) const = 0;
+	/** Returns true if the list contains no value; otherwise returns false */
+	virtual bool isEmpty (void) const = 0;
+	/** Removes all values from the list, with a single model reset */
+	virtual void clear (void) = 0;
+	/** Moves the value at index position idx to index position pos */
+	virtual void move (int idx, int pos) = 0;
+	/** Removes the value at index position idx */
+	virtual void remove (int idx) = 0;
+	/** Removes count values starting at index position first, with a single remove notification */
+	virtual void removeRange (int first, int count) = 0;
+	/** Returns a copy of the value at idx, invalid if idx is out of range */
+	virtual QVariant get (int idx) const = 0;
+
+signals: // notifier
+	/** Emitted when count changed (ie removed or inserted values) */
+    void countChanged (void);
+};
+
+/**
+ * List model of Q_GADGET values, stored contiguously in a QVector<T>.
+ *
+ * Rows that are plain data don't need a QObject each : every Q_PROPERTY of
+ * the gadget is a role, read and written in place with readOnGadget() and
+ * writeOnGadget(). Gadgets have no notify signals, so values are changed
+ * through set() and update(), which compare the roles before and after the
+ * change and emit a single dataChanged with only the roles that changed.
+ *
+ * The 'qtObject' role and get() return a copy of the gadget, T must be
+ * declared with Q_DECLARE_METATYPE.
+ *
+ * \code
+ * QQmlGadgetListModel<Point> points;
+ * points.append (Point (0, 0));
+ * points.update (0, [] (Point & point) { point.setX (12); }); // dataChanged on the 'x' role only
+ * \endcode
+ */
+template<class T> class QQmlGadgetListModel : public QQmlVectorListModel<T, QQmlGadgetListModelBase>
+{
+    typedef QQmlVectorListModel<T, QQmlGadgetListModelBase> Storage;
+    using Storage::m_items;
+
+public:
+    explicit QQmlGadgetListModel (QObject *                 parent       = Q_NULLPTR,
+                                  const QList<QByteArray> & exposedRoles = QList<QByteArray> (),
+                                  const QByteArray &        displayRole  = QByteArray ())
+        : Storage (parent)
+        , m_roleTable (QQmlObjectRoleTable::cached (T::staticMetaObject, exposedRoles, displayRole, QByteArray (), "QQmlGadgetListModel"))
+    {
+        // Roles compared by set() and update(), Qt::DisplayRole being only an alias
+        const QHash<int, QByteArray> & roles = m_roleTable->roleNames ();
+        for (QHash<int, QByteArray>::const_iterator it = roles.constBegin (); it != roles.constEnd (); ++it) {
+            if (it.key () != QQmlObjectRoleTable::baseRole () && it.key () != Qt::DisplayRole) {
+                m_valueRoles.append (it.key ());
+            }
+        }
+        std::sort (m_valueRoles.begin (), m_valueRoles.end ());
+    }
+    bool setData (const QModelIndex & index, const QVariant & value, int role) Q_DECL_FINAL {
+        const int row = index.row ();
+        if (row < 0 || row >= m_items.count () || role == QQmlObjectRoleTable::baseRole ()) {
+            return false;
+        }
+        const bool ret = m_roleTable->writeOnGadget (&m_items [row], role, value);
+        if (ret) {
+            notifyChanged (row, withAlias (QVector<int> () << role));
+        }
+        return ret;
+    }
+    QVariant data (const QModelIndex & index, int role) const Q_DECL_FINAL {
+        QVariant ret;
+        const int row = index.row ();
+        if (row >= 0 && row < m_items.count ()) {
+            const T & value = m_items.at (row);
+            ret = (role != QQmlObjectRoleTable::baseRole () ? m_roleTable->readOnGadget (&value, role) : QVariant::fromValue (value));
+        }
+        return ret;
+    }
+    QHash<int, QByteArray> roleNames (void) const Q_DECL_FINAL {
+        return m_roleTable->roleNames ();
+    }
+
+public: // C++ API
+	int roleForName (const QByteArray & name) const {
+        return m_roleTable->roleForName (name);
+    }
+	QVariant get (int idx) const Q_DECL_FINAL {
+        return (idx >= 0 && idx < m_items.count () ? QVariant::fromValue (m_items.at (idx)) : QVariant ());
+    }
+	/** Replace the content of the model by values, with a single model reset */
+	void setItems (const QVector<T> & values) {
+        this->beginResetModel ();
+        m_items = values;
+        this->updateCounter ();
+        this->endResetModel ();
+    }
+	/** Replace the value at row, and notify the roles whose value changed.
+	 * \return Whether a role changed */
+	bool set (int row, const T & value) {
+        if (row < 0 || row >= m_items.count ()) {
+            return false;
+        }
+        const QVector<int> roles = changedRoles (m_items.at (row), value);
+        if (roles.isEmpty ()) {
+            return false;
+        }
+        m_items [row] = value;
+        notifyChanged (row, withAlias (roles));
+        return true;
+    }
+	/** Call updater (T &) on the value at row, in place, and notify the roles whose value changed.
+	 * \return Whether a role changed */
+	template<class Updater> bool update (int row, Updater updater) {
+        if (row < 0 || row >= m_items.count ()) {
+            return false;
+        }
+        const T before = m_items.at (row);
+        updater (m_items [row]);
+        const QVector<int> roles = changedRoles (before, m_items.at (row));
+        if (!roles.isEmpty ()) {
+            notifyChanged (row, withAlias (roles));
+        }
+        return !roles.isEmpty ();
+    }
+	/** Removes the value at row and returns it, row must be valid */
+	T takeAt (int row) {
+        const T ret = m_items.at (row);
+        this->remove (row);
+        return ret;
+    }
+
+protected: // internal stuff
+    /** Exposed roles whose value differs between before and after */
+    QVector<int> changedRoles (const T & before, const T & after) const {
+        QVector<int> ret;
+        for (QVector<int>::const_iterator it = m_valueRoles.constBegin (); it != m_valueRoles.constEnd (); ++it) {
+            if (m_roleTable->readOnGadget (&before, * it) != m_roleTable->readOnGadget (&after, * it)) {
+                ret.append (* it);
+            }
+        }
+        return ret;
+    }
+    /** roles, with Qt::DisplayRole and the display property notified together */
+    QVector<int> withAlias (QVector<int> roles) const {
+        const int displayRole = m_roleTable->displayRole ();
+        if (displayRole >= 0) {
+            if (roles.contains (displayRole) && !roles.contains (Qt::DisplayRole)) {
+                roles.append (Qt::DisplayRole);
+            }
+            else if (roles.contains (Qt::DisplayRole) && !roles.contains (displayRole)) {
+                roles.append (displayRole);
+            }
+        }
+        return roles;
+    }
+    void notifyChanged (int row, const QVector<int> & roles) {
+        const QModelIndex index = this->QAbstractListModel::index (row, 0, Storage::noParent ());
+        emit this->dataChanged (index, index, roles);
+    }
+
+private: // data members
+    QSharedPointer<const QQmlObjectRoleTable> m_roleTable;
+    QVector<int>                              m_valueRoles;
+};
+
+#define QQMLMODEL_GADGET_PROPERTY(type, name, Name) \
+    QQMLMODEL_GADGET_PROPERTY_SUB(QQMLMODEL_NAMESPACE_NAME::QQmlGadgetListModel<type>, name, Name)
+
+#define QQMLMODEL_GADGET_PROPERTY_SUB(type, name, Name) \
+    protected: Q_PROPERTY (QQMLMODEL_NAMESPACE_NAME::QQmlGadgetListModelBase * name READ Get##Name CONSTANT) \
+    private: type * _##name = new type(this); \
+    public: type * Get##Name (void) const { return _##name; } \
+    private:
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLGADGETLISTMODEL_H
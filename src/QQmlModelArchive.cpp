@@ -0,0 +1,146 @@
+#include <QDebug>
+#include <QIODevice>
+
+#include "QQmlModelArchive.h"
+
+QQMLMODEL_USING_NAMESPACE;
+
+/*!
+    \internal
+    \details 'QQMA', first bytes of every archive.
+*/
+static const quint32 ARCHIVE_MAGIC = 0x51514D41;
+
+/*!
+    \class QQmlModelArchive
+
+    \ingroup QT_QML_MODELS
+
+    \brief Versioned binary format used by the save() and load() methods of the models
+
+    The stream is set to \c QDataStream::Qt_5_0 so that archives don't depend on the Qt version that wrote them.
+
+    \sa QQmlObjectListModel, QQmlVariantListModel
+*/
+
+/*!
+    \details Returns whether \a type has stream operators, by saving a default value once.
+*/
+bool QQmlModelArchive::isStreamable (int type)
+{
+    if (type == QMetaType::UnknownType || type == QMetaType::Void) {
+        return false;
+    }
+    QByteArray probe;
+    QDataStream stream (&probe, QIODevice::WriteOnly);
+    const QVariant value (type, Q_NULLPTR);
+    return QMetaType::save (stream, type, value.constData ());
+}
+
+/*!
+    \details Writes the magic number, the format version, the name and type name of each of \a columns, then \a rows.
+*/
+bool QQmlModelArchive::writeHeader (QDataStream & stream, const QVector<Column> & columns, qint32 rows)
+{
+    stream.setVersion (QDataStream::Qt_5_0);
+    stream << ARCHIVE_MAGIC << version () << qint32 (columns.count ());
+    for (QVector<Column>::const_iterator it = columns.constBegin (); it != columns.constEnd (); ++it) {
+        stream << it->name << QByteArray (QMetaType::typeName (it->type));
+    }
+    stream << rows;
+    return (stream.status () == QDataStream::Ok);
+}
+
+/*!
+    \details Reads a header written by writeHeader() into \a columns and \a rows.
+
+    Types are saved by name, since the ids of custom types change between runs.
+
+    \return false when the magic number or the version don't match, when a type isn't registered in this process,
+    or when rows are announced without any column
+*/
+bool QQmlModelArchive::readHeader (QDataStream & stream, QVector<Column> & columns, qint32 & rows)
+{
+    stream.setVersion (QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint16 format = 0;
+    qint32 count = 0;
+    stream >> magic >> format >> count;
+    if (magic != ARCHIVE_MAGIC || format != version () || count < 0) {
+        return false;
+    }
+    columns.clear ();
+    columns.reserve (reserveHint (stream, count, 8)); // two byte array sizes at least
+    for (int idx = 0; idx < count; ++idx) {
+        QByteArray name;
+        QByteArray typeName;
+        stream >> name >> typeName;
+        const int type = QMetaType::type (typeName.constData ());
+        if (type == QMetaType::UnknownType) {
+            qWarning () << "QQmlModelArchive : unknown type" << typeName << "for role" << name;
+            return false;
+        }
+        columns.append (Column (name, type));
+    }
+    stream >> rows;
+    // Rows of no column take no byte, nothing would bound the rows of a forged header
+    return (stream.status () == QDataStream::Ok && rows >= 0 && (rows == 0 || !columns.isEmpty ()));
+}
+
+/*!
+    \details Writes \a value as \a type, an invalid or mismatching value being converted, or replaced by a default one.
+*/
+bool QQmlModelArchive::writeValue (QDataStream & stream, int type, const QVariant & value)
+{
+    if (type == QMetaType::QVariant) {
+        return QMetaType::save (stream, type, &value);
+    }
+    else if (value.userType () == type) {
+        return QMetaType::save (stream, type, value.constData ());
+    }
+    QVariant converted (value);
+    if (!converted.convert (type)) {
+        converted = QVariant (type, Q_NULLPTR);
+    }
+    return QMetaType::save (stream, type, converted.constData ());
+}
+
+/*!
+    \details Reads a value of \a type written by writeValue().
+*/
+QVariant QQmlModelArchive::readValue (QDataStream & stream, int type)
+{
+    if (type == QMetaType::QVariant) {
+        QVariant ret;
+        stream >> ret;
+        return ret;
+    }
+    QVariant ret (type, Q_NULLPTR);
+    QMetaType::load (stream, type, ret.data ());
+    return ret;
+}
+
+/*!
+    \details Returns \a count, capped to the number of entries of \a entrySize bytes the device of \a stream still holds.
+
+    Counts are read from the archive, a truncated or forged one must not make load() allocate more than the data can fill.
+*/
+int QQmlModelArchive::reserveHint (const QDataStream & stream, qint32 count, int entrySize)
+{
+    const QIODevice * device = stream.device ();
+    if (device == Q_NULLPTR || count <= 0) {
+        return 0;
+    }
+    return int (qMin<qint64> (count, device->bytesAvailable () / qMax (entrySize, 1)));
+}
+
+/*!
+    \details Returns whether the device of \a stream still holds \a size bytes, the least a row can take.
+
+    Checked before each row is created, so that a forged row count can't make load() create items past the end of the data.
+*/
+bool QQmlModelArchive::hasRowLeft (const QDataStream & stream, int size)
+{
+    const QIODevice * device = stream.device ();
+    return (device != Q_NULLPTR && device->bytesAvailable () >= qMax (size, 1));
+}
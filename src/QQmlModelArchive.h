@@ -0,0 +1,60 @@
+#ifndef QQMLMODELARCHIVE_H
+#define QQMLMODELARCHIVE_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QVariant>
+#include <QVector>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * Binary format of the save() and load() methods of the models.
+ *
+ * A header describes the schema : a magic number, the format version, then
+ * the name and type name of every saved role, and the number of rows. Rows
+ * follow, each one being the values of the roles in the header order,
+ * written with QMetaType::save() and without any per value type tag.
+ *
+ * Roles are matched by name on load, so a model can load an archive whose
+ * roles were added, removed or reordered since, as long as every saved type
+ * is still known to the meta type system.
+ */
+class QQMLMODEL_API_ QQmlModelArchive
+{
+public:
+    /** A saved role */
+    struct Column {
+        Column (void) : type (QMetaType::UnknownType) { }
+        Column (const QByteArray & name, int type) : name (name), type (type) { }
+
+        QByteArray name;
+        int        type;
+    };
+
+    /** Version of the format written by this build */
+    static quint16 version (void) { return 1; }
+
+    /** Whether values of type can be written and read back */
+    static bool isStreamable (int type);
+    /** Write the header of an archive of rows rows with columns */
+    static bool writeHeader (QDataStream & stream, const QVector<Column> & columns, qint32 rows);
+    /** Read the header written by writeHeader (), resolving the column types in this process.
+     * \return false if the device doesn't hold a supported archive, a type is unknown here, or rows have no column */
+    static bool readHeader (QDataStream & stream, QVector<Column> & columns, qint32 & rows);
+    /** Write value as type, converting it when needed */
+    static bool writeValue (QDataStream & stream, int type, const QVariant & value);
+    /** Read a value of type */
+    static QVariant readValue (QDataStream & stream, int type);
+    /** Capacity worth reserving for count entries read from stream, each one taking at least entrySize bytes.
+     * count comes from the archive itself, the bytes left on the device bound it */
+    static int reserveHint (const QDataStream & stream, qint32 count, int entrySize);
+    /** Whether stream has at least size bytes left, size being the least a row of the archive takes : one per column */
+    static bool hasRowLeft (const QDataStream & stream, int size);
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLMODELARCHIVE_H
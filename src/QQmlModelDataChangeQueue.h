@@ -0,0 +1,91 @@
+#ifndef QQMLMODELDATACHANGEQUEUE_H
+#define QQMLMODELDATACHANGEQUEUE_H
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QVector>
+
+#include <algorithm>
+
+#include "QQmlModelRowIndex.h"
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * Pending dataChanged accumulator used by the object list models when
+ * coalesceDataChanged is enabled.
+ *
+ * Dirty roles are stored per item rather than per row, so rows are only
+ * resolved when flushing and structural changes in between don't need to
+ * flush first. On flush, contiguous dirty rows are merged into a single
+ * range notified with the union of their roles.
+ */
+class QQmlModelDataChangeQueue
+{
+public:
+    bool isEmpty (void) const {
+        return m_roles.isEmpty ();
+    }
+    void clear (void) {
+        m_roles.clear ();
+    }
+    /** Mark role of item as dirty. Returns true when the queue was empty, ie a flush must be scheduled */
+    bool append (const QObject * item, int role) {
+        const bool wasEmpty = m_roles.isEmpty ();
+        QVector<int> & roles = m_roles [item];
+        if (!roles.contains (role)) {
+            roles.append (role);
+        }
+        return wasEmpty;
+    }
+    /** Forget pending changes of an item leaving the model */
+    void remove (const QObject * item) {
+        if (!m_roles.isEmpty ()) {
+            m_roles.remove (item);
+        }
+    }
+    /** Call emitter (first, last, roles) once per contiguous range of dirty rows */
+    template<class List, class Emitter> void flush (const QQmlModelRowIndex & rowIndex, const List & list, Emitter emitter) {
+        if (m_roles.isEmpty ()) {
+            return;
+        }
+        // Take the pending changes first, emitter may trigger new ones
+        QHash<const QObject *, QVector<int> > pending;
+        pending.swap (m_roles);
+        typedef QPair<int, const QVector<int> *> DirtyRow;
+        QVector<DirtyRow> rows;
+        rows.reserve (pending.size ());
+        for (typename QHash<const QObject *, QVector<int> >::const_iterator it = pending.constBegin (); it != pending.constEnd (); ++it) {
+            const int row = rowIndex.rowOf (it.key (), list);
+            if (row >= 0) {
+                rows.append (DirtyRow (row, &it.value ()));
+            }
+        }
+        std::sort (rows.begin (), rows.end (), [] (const DirtyRow & a, const DirtyRow & b) { return a.first < b.first; });
+        int idx = 0;
+        while (idx < rows.size ()) {
+            const int first = rows.at (idx).first;
+            int last = first;
+            QVector<int> roles = * rows.at (idx).second;
+            for (++idx; idx < rows.size () && rows.at (idx).first == last +1; ++idx) {
+                ++last;
+                const QVector<int> & rowRoles = * rows.at (idx).second;
+                for (QVector<int>::const_iterator role = rowRoles.constBegin (); role != rowRoles.constEnd (); ++role) {
+                    if (!roles.contains (* role)) {
+                        roles.append (* role);
+                    }
+                }
+            }
+            emitter (first, last, roles);
+        }
+    }
+
+private:
+    QHash<const QObject *, QVector<int> > m_roles;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLMODELDATACHANGEQUEUE_H
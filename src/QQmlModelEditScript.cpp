@@ -0,0 +1,196 @@
+#include "QQmlModelEditScript.h"
+
+QQMLMODEL_USING_NAMESPACE;
+
+/*!
+    \internal
+    \details Flags the items of \a values that are part of one longest strictly increasing subsequence.
+*/
+static QVector<bool> longestIncreasingRun (const QVector<int> & values)
+{
+    QVector<int> tails; // index of the last value of the best subsequence of each length
+    QVector<int> previous (values.size (), -1);
+    for (int idx = 0; idx < values.size (); ++idx) {
+        const int value = values.at (idx);
+        int lo = 0;
+        int hi = tails.size ();
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (values.at (tails.at (mid)) < value) {
+                lo = mid +1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        if (lo > 0) {
+            previous [idx] = tails.at (lo -1);
+        }
+        if (lo == tails.size ()) {
+            tails.append (idx);
+        }
+        else {
+            tails [lo] = idx;
+        }
+    }
+    QVector<bool> ret (values.size (), false);
+    for (int idx = (tails.isEmpty () ? -1 : tails.last ()); idx >= 0; idx = previous.at (idx)) {
+        ret [idx] = true;
+    }
+    return ret;
+}
+
+/*!
+    \internal
+    \details Builds in O(n) a Fenwick tree over \a occupied, giving the rank of a slot among the occupied ones.
+*/
+static QVector<int> rankTree (const QVector<int> & occupied)
+{
+    QVector<int> ret (occupied);
+    for (int idx = 0; idx < ret.size (); ++idx) {
+        const int parent = (idx | (idx +1));
+        if (parent < ret.size ()) {
+            ret [parent] += ret.at (idx);
+        }
+    }
+    return ret;
+}
+
+/*!
+    \internal
+    \details Adds \a delta to the slot \a idx of \a tree.
+*/
+static void rankTreeAdd (QVector<int> & tree, int idx, int delta)
+{
+    for (; idx < tree.size (); idx |= (idx +1)) {
+        tree [idx] += delta;
+    }
+}
+
+/*!
+    \internal
+    \details Number of occupied slots in [0, \a idx] of \a tree.
+*/
+static int rankTreeCount (const QVector<int> & tree, int idx)
+{
+    int ret = 0;
+    for (; idx >= 0; idx = (idx & (idx +1)) -1) {
+        ret += tree.at (idx);
+    }
+    return ret;
+}
+
+/*!
+    \details Computes the minimal remove, move and insert sequence turning the current list into the target list.
+
+    Removals and insertions are O(n). Only the items out of the longest in-order run are moved,
+    the rows of a move are read from a rank tree over slots laid out in advance, so d moves cost
+    O(d log n) instead of a scan of the list each.
+
+    \param targetRows The row in the target list of every current item, -1 when the item is removed
+    \param targetCount The size of the target list
+    \return The edits, to apply in order
+*/
+QVector<QQmlModelEdit> QQmlModelEditScript::compute (const QVector<int> & targetRows, int targetCount)
+{
+    QVector<QQmlModelEdit> ret;
+
+    // Removals, last run first so the rows of the remaining runs stay valid
+    QVector<int> survivors;
+    survivors.reserve (targetRows.size ());
+    for (int row = targetRows.size () -1; row >= 0; --row) {
+        if (targetRows.at (row) < 0) {
+            const int last = row;
+            while (row > 0 && targetRows.at (row -1) < 0) {
+                --row;
+            }
+            ret.append (QQmlModelEdit (QQmlModelEdit::Remove, row, last));
+        }
+    }
+    for (int row = 0; row < targetRows.size (); ++row) {
+        if (targetRows.at (row) >= 0) {
+            survivors.append (targetRows.at (row));
+        }
+    }
+
+    // Moves, every item out of the longest in-order run is placed right after its target predecessor.
+    // Targets are visited in increasing order, so the moved items following a stable item (or the
+    // head of the list) land there one after the other, in target order : each of them gets a slot
+    // reserved after the slot of that stable item, and a row is the rank of its slot among the
+    // occupied ones.
+    const QVector<bool> inOrder = longestIncreasingRun (survivors);
+    if (inOrder.contains (false)) {
+        QVector<int> indexOfTarget (targetCount, -1);
+        for (int idx = 0; idx < survivors.size (); ++idx) {
+            indexOfTarget [survivors.at (idx)] = idx;
+        }
+        int headSize = 0;
+        QVector<int> groupSize (survivors.size (), 0);
+        int owner = -1;
+        for (int target = 0; target < targetCount; ++target) {
+            const int idx = indexOfTarget.at (target);
+            if (idx < 0) {
+                continue;
+            }
+            if (inOrder.at (idx)) {
+                owner = idx;
+            }
+            else if (owner < 0) {
+                ++headSize;
+            }
+            else {
+                ++groupSize [owner];
+            }
+        }
+        QVector<int> originalSlot (survivors.size ());
+        QVector<int> groupStart (survivors.size (), -1);
+        int slotCount = headSize;
+        for (int idx = 0; idx < survivors.size (); ++idx) {
+            originalSlot [idx] = slotCount++;
+            if (inOrder.at (idx)) {
+                groupStart [idx] = slotCount;
+                slotCount += groupSize.at (idx);
+            }
+        }
+        QVector<int> occupied (slotCount, 0);
+        for (int idx = 0; idx < survivors.size (); ++idx) {
+            occupied [originalSlot.at (idx)] = 1;
+        }
+        QVector<int> tree = rankTree (occupied);
+        int cursor = 0;
+        for (int target = 0; target < targetCount; ++target) {
+            const int idx = indexOfTarget.at (target);
+            if (idx < 0) {
+                continue;
+            }
+            if (inOrder.at (idx)) {
+                cursor = groupStart.at (idx);
+                continue;
+            }
+            const int src = (rankTreeCount (tree, originalSlot.at (idx)) -1);
+            rankTreeAdd (tree, originalSlot.at (idx), -1);
+            const int slot = cursor++;
+            rankTreeAdd (tree, slot, +1);
+            const int dest = (rankTreeCount (tree, slot) -1);
+            if (src != dest) {
+                ret.append (QQmlModelEdit (QQmlModelEdit::Move, src, src, dest));
+            }
+        }
+    }
+
+    // Insertions, first run first so every run lands at its target row
+    QVector<bool> present (targetCount, false);
+    for (QVector<int>::const_iterator it = survivors.constBegin (); it != survivors.constEnd (); ++it) {
+        present [* it] = true;
+    }
+    for (int row = 0; row < targetCount; ++row) {
+        if (!present.at (row)) {
+            const int first = row;
+            while (row +1 < targetCount && !present.at (row +1)) {
+                ++row;
+            }
+            ret.append (QQmlModelEdit (QQmlModelEdit::Insert, first, row));
+        }
+    }
+    return ret;
+}
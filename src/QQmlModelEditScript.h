@@ -0,0 +1,50 @@
+#ifndef QQMLMODELEDITSCRIPT_H
+#define QQMLMODELEDITSCRIPT_H
+
+#include <QVector>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * One structural change of a list model, in the coordinates of the list
+ * as it is right before the change is applied.
+ */
+struct QQMLMODEL_API_ QQmlModelEdit
+{
+    enum Type {
+        Remove, /**< Rows [first, last] are removed */
+        Move,   /**< Row first is moved to row dest, like QList::move */
+        Insert  /**< Rows [first, last] of the target list are inserted at first */
+    };
+
+    QQmlModelEdit (void) : type (Remove), first (-1), last (-1), dest (-1) { }
+    QQmlModelEdit (Type type, int first, int last, int dest = -1) : type (type), first (first), last (last), dest (dest) { }
+
+    Type type;
+    int  first;
+    int  last;
+    int  dest;
+};
+
+/**
+ * Computes the edits turning a list of unique items into a target list.
+ *
+ * The current list is described by the row each of its items has in the
+ * target list (-1 when the item isn't in the target anymore). The script
+ * removes missing items as contiguous runs starting from the end, moves only
+ * the items that aren't part of the longest run already in target order,
+ * then inserts new items as contiguous runs from the start.
+ */
+class QQMLMODEL_API_ QQmlModelEditScript
+{
+public:
+    /** \param targetRows Target row of every item of the current list, -1 if removed
+     * \param targetCount Size of the target list */
+    static QVector<QQmlModelEdit> compute (const QVector<int> & targetRows, int targetCount);
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLMODELEDITSCRIPT_H
@@ -0,0 +1,117 @@
+#include "QQmlModelFeed.h"
+
+QQMLMODEL_USING_NAMESPACE;
+
+/*!
+    \class QQmlModelFeedBase
+
+    \ingroup QT_QML_MODELS
+
+    \brief Non template part of QQmlModelFeed : wake-ups, drain timer and back-pressure statistics
+
+    Producers only touch the atomic counters, everything else belongs to the thread of the model.
+
+    \sa QQmlModelFeed
+*/
+
+/*!
+    \details Constructs a feed that drains on wake-up, unbounded and without batch size limit.
+*/
+QQmlModelFeedBase::QQmlModelFeedBase (QObject * parent) : QObject (parent)
+  , m_timer (this)
+  , m_capacity (0)
+  , m_maxBatchSize (0)
+  , m_interval (0)
+  , m_pending (0)
+  , m_peakPending (0)
+  , m_rejected (0)
+  , m_pushed (0)
+  , m_applied (0)
+  , m_dropped (0)
+  , m_batches (0)
+{
+    m_timer.setInterval (0);
+    connect (&m_timer, &QTimer::timeout, this, &QQmlModelFeedBase::drain);
+}
+
+/*!
+    \details Drains every \a msecs milliseconds, or on wake-up when \a msecs is 0.
+
+    Must be called on the thread of the model.
+*/
+void QQmlModelFeedBase::setDrainInterval (int msecs)
+{
+    m_timer.setInterval (qMax (msecs, 0));
+    m_interval.store (m_timer.interval ()); // producers read it
+    if (msecs > 0) {
+        m_timer.start ();
+    }
+    else {
+        m_timer.stop ();
+        if (pending () > 0) {
+            QMetaObject::invokeMethod (this, "drain", Qt::QueuedConnection);
+        }
+    }
+}
+
+/*!
+    \details Returns the statistics. Counters are read one by one, they can be slightly apart while producers push.
+*/
+QQmlModelFeedStats QQmlModelFeedBase::stats (void) const
+{
+    QQmlModelFeedStats ret;
+    ret.pushed = m_pushed.load ();
+    ret.rejected = m_rejected.load ();
+    ret.applied = m_applied.load ();
+    ret.dropped = m_dropped.load ();
+    ret.batches = m_batches.load ();
+    ret.pending = m_pending.load ();
+    ret.peakPending = m_peakPending.load ();
+    return ret;
+}
+
+/*!
+    \internal
+    \details Counts a new pending operation, or a rejected one when the feed is full. Thread safe.
+*/
+bool QQmlModelFeedBase::reserve (void)
+{
+    const int pending = (m_pending.fetchAndAddOrdered (1) +1);
+    const int capacity = m_capacity.load ();
+    if (capacity > 0 && pending > capacity) {
+        m_pending.fetchAndAddOrdered (-1);
+        m_rejected.fetchAndAddRelaxed (1);
+        return false;
+    }
+    m_pushed.fetchAndAddRelaxed (1);
+    int peak = m_peakPending.load ();
+    while (pending > peak && !m_peakPending.testAndSetRelaxed (peak, pending, peak)) { }
+    return true;
+}
+
+/*!
+    \internal
+    \details Posts a drain to the thread of the model when \a first is true and no timer drains periodically. Thread safe.
+*/
+void QQmlModelFeedBase::wake (bool first)
+{
+    if (first && m_interval.load () == 0) {
+        QMetaObject::invokeMethod (this, "drain", Qt::QueuedConnection);
+    }
+}
+
+/*!
+    \internal
+    \details Updates the statistics after a drain applied \a applied operations and dropped \a dropped ones,
+    and schedules the next drain when \a remaining operations were held back by maxBatchSize.
+*/
+void QQmlModelFeedBase::countApplied (int applied, int dropped, int remaining)
+{
+    m_pending.fetchAndAddOrdered (-(applied + dropped));
+    m_applied.fetchAndAddRelaxed (applied);
+    m_dropped.fetchAndAddRelaxed (dropped);
+    m_batches.fetchAndAddRelaxed (applied > 0 ? 1 : 0);
+    if (remaining > 0 && m_timer.interval () == 0) {
+        QMetaObject::invokeMethod (this, "drain", Qt::QueuedConnection);
+    }
+}
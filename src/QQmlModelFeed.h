@@ -0,0 +1,287 @@
+#ifndef QQMLMODELFEED_H
+#define QQMLMODELFEED_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QtAlgorithms>
+#include <QByteArray>
+#include <QList>
+#include <QMetaObject>
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+#include <QVariant>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/** Back-pressure statistics of a QQmlModelFeed */
+struct QQmlModelFeedStats
+{
+    /** Operations accepted by push methods */
+    qint64 pushed;
+    /** Operations refused because the feed was full */
+    qint64 rejected;
+    /** Operations applied on the model */
+    qint64 applied;
+    /** Operations dropped when drained : row out of range, unknown role, or model deleted */
+    qint64 dropped;
+    /** Number of drains that applied operations, each one is a single model batch */
+    qint64 batches;
+    /** Operations waiting to be applied */
+    int    pending;
+    /** Highest pending value seen */
+    int    peakPending;
+};
+
+class QQMLMODEL_API_ QQmlModelFeedBase : public QObject { // abstract Qt base class
+    Q_OBJECT
+
+public:
+    explicit QQmlModelFeedBase (QObject * parent = Q_NULLPTR);
+
+	/** Maximum number of pending operations, push methods refuse new ones above it. 0, the default, means unbounded */
+    int capacity (void) const { return m_capacity.load (); }
+    void setCapacity (int capacity) { m_capacity.store (qMax (capacity, 0)); }
+	/** Maximum number of operations applied by a drain, the next ones wait for the next event loop iteration.
+	 * 0, the default, applies everything that is pending */
+    int maxBatchSize (void) const { return m_maxBatchSize; }
+    void setMaxBatchSize (int maxBatchSize) { m_maxBatchSize = qMax (maxBatchSize, 0); }
+	/** When 0, the default, the first push after a drain wakes the event loop of the model up.
+	 * Otherwise operations are drained every interval milliseconds, which groups more of them per batch */
+    int drainInterval (void) const { return m_timer.interval (); }
+    void setDrainInterval (int msecs);
+
+	/** Thread safe snapshot of the statistics */
+    QQmlModelFeedStats stats (void) const;
+	/** Number of operations waiting to be applied, thread safe */
+    int pending (void) const { return m_pending.load (); }
+
+public slots:
+	/** Apply the pending operations on the model in one batch. Called on the thread of the model */
+    virtual void drain (void) = 0;
+
+protected: // called by the producers
+    /** Reserve room for one operation. \return false if the feed is full */
+    bool reserve (void);
+    /** Wake the model thread up if this is the first pending operation */
+    void wake (bool first);
+
+protected: // called by drain
+    void countApplied (int applied, int dropped, int remaining);
+
+private:
+    QTimer                 m_timer;
+    QAtomicInt             m_capacity;
+    int                    m_maxBatchSize;
+    QAtomicInt             m_interval;
+    QAtomicInt             m_pending;
+    QAtomicInt             m_peakPending;
+    QAtomicInt             m_rejected;
+    QAtomicInt             m_pushed;
+    QAtomicInteger<qint64> m_applied;
+    QAtomicInteger<qint64> m_dropped;
+    QAtomicInteger<qint64> m_batches;
+};
+
+/** Hands item over to the thread of the model, before it is queued by a worker thread */
+inline void qqmlModelFeedAdopt (QObject * item, QThread * thread) {
+    if (item != Q_NULLPTR && item->thread () != thread) {
+        item->moveToThread (thread);
+    }
+}
+inline void qqmlModelFeedAdopt (const QVariant &, QThread *) { }
+
+/** Deletes an item adopted by a push whose insertion was dropped, unless something else owns it */
+inline void qqmlModelFeedDispose (QObject * item) {
+    if (item != Q_NULLPTR && item->parent () == Q_NULLPTR) {
+        delete item;
+    }
+}
+inline void qqmlModelFeedDispose (const QVariant &) { }
+
+/**
+ * Multi-producer queue feeding a model from worker threads.
+ *
+ * Model methods must be called on the thread of the model. Instead of a
+ * queued invocation per item, workers push insert, remove and update
+ * operations on the feed, from any thread and without locking : each push is
+ * a compare-and-swap on the head of a linked stack. The thread of the model
+ * takes the whole stack at once and applies it in order inside a single
+ * model batch, so views get one structural notification per drain.
+ *
+ * Works with QQmlObjectListModel<T> (Value = T *) and QQmlVariantListModel
+ * (Value = QVariant). Objects pushed from a worker thread are moved to the
+ * thread of the model by the push itself.
+ *
+ * Rows are resolved when the operation is applied, operations whose row is
+ * out of range by then are dropped. Objects of dropped insertions, and of
+ * insertions still pending when the feed or its model goes away, are
+ * deleted unless they have a parent.
+ *
+ * A push refused because the feed is full takes nothing : the caller keeps
+ * the ownership of the value.
+ *
+ * \code
+ * QQmlModelFeed<QQmlObjectListModel<Message>, Message *> * feed = new QQmlModelFeed<...> (model);
+ * // in a worker thread :
+ * Message * message = new Message (json);
+ * if (!feed->pushAppend (message)) {
+ *     delete message;
+ *     throttle ();
+ * }
+ * \endcode
+ */
+template<class Model, class Value> class QQmlModelFeed : public QQmlModelFeedBase
+{
+public:
+    /** The feed is a child of model, and lives in its thread */
+    explicit QQmlModelFeed (Model * model)
+        : QQmlModelFeedBase (model)
+        , m_model (model)
+        , m_head (Q_NULLPTR)
+    { }
+    /** Pending operations are dropped */
+    ~QQmlModelFeed (void) {
+        Node * node = m_head.fetchAndStoreAcquire (Q_NULLPTR);
+        while (node != Q_NULLPTR) {
+            Node * next = node->next;
+            dispose (node);
+            node = next;
+        }
+        for (typename QList<Node *>::const_iterator it = m_backlog.constBegin (); it != m_backlog.constEnd (); ++it) {
+            dispose (* it);
+        }
+    }
+
+    /** Queue the insertion of value at the end of the model.
+     * \return false if the feed is full, value is then left to the caller */
+    bool pushAppend (const Value & value) {
+        return pushInsert (-1, value);
+    }
+    /** Queue the insertion of value at row, -1 meaning the end of the model.
+     * \return false if the feed is full, value is then left to the caller */
+    bool pushInsert (int row, const Value & value) {
+        if (!reserve ()) {
+            return false;
+        }
+        qqmlModelFeedAdopt (value, thread ());
+        Node * node = new Node (Insert, row, 1);
+        node->value = value;
+        return push (node);
+    }
+    /** Queue the removal of count rows starting at row. \return false if the feed is full */
+    bool pushRemove (int row, int count = 1) {
+        return (reserve () && push (new Node (Remove, row, count)));
+    }
+    /** Queue setData (row, roleName, value). \return false if the feed is full */
+    bool pushUpdate (int row, const QByteArray & roleName, const QVariant & value) {
+        if (!reserve ()) {
+            return false;
+        }
+        Node * node = new Node (Update, row, 1);
+        node->role = roleName;
+        node->data = value;
+        return push (node);
+    }
+
+    void drain (void) Q_DECL_FINAL {
+        // The stack gives the operations newest first, the backlog keeps them oldest first
+        QList<Node *> taken;
+        for (Node * node = m_head.fetchAndStoreAcquire (Q_NULLPTR); node != Q_NULLPTR; node = node->next) {
+            taken.prepend (node);
+        }
+        m_backlog.append (taken);
+        if (m_backlog.isEmpty ()) {
+            return;
+        }
+        const int count = (maxBatchSize () > 0 ? qMin (maxBatchSize (), m_backlog.count ()) : m_backlog.count ());
+        int applied = 0;
+        if (!m_model.isNull ()) {
+            QQmlModelBatch<Model> batch (m_model.data ());
+            for (int idx = 0; idx < count; ++idx) {
+                applied += (apply (* m_backlog [idx]) ? 1 : 0);
+            }
+        }
+        for (int idx = 0; idx < count; ++idx) {
+            dispose (m_backlog.at (idx));
+        }
+        m_backlog.erase (m_backlog.begin (), m_backlog.begin () + count);
+        countApplied (applied, count - applied, m_backlog.count ());
+    }
+
+protected: // internal stuff
+    enum Kind { Insert, Remove, Update };
+
+    struct Node {
+        Node (Kind kind, int row, int count) : kind (kind), row (row), count (count), value (), next (Q_NULLPTR) { }
+
+        Kind       kind;
+        int        row;
+        int        count;
+        Value      value;
+        QByteArray role;
+        QVariant   data;
+        Node *     next;
+    };
+
+    bool push (Node * node) {
+        Node * head = m_head.loadAcquire ();
+        do {
+            node->next = head;
+        } while (!m_head.testAndSetOrdered (head, node, head));
+        wake (head == Q_NULLPTR);
+        return true;
+    }
+    /** Deletes node, and the value of an insertion that wasn't applied */
+    static void dispose (Node * node) {
+        if (node->kind == Insert) {
+            qqmlModelFeedDispose (node->value);
+        }
+        delete node;
+    }
+    /** Applies node on the model, an applied insertion gives its value to the model.
+     * \return false if the operation was dropped */
+    bool apply (Node & node) {
+        Model * model = m_model.data ();
+        switch (node.kind) {
+            case Insert: {
+                const int row = (node.row < 0 ? model->pendingCount () : node.row);
+                if (row <= model->pendingCount ()) {
+                    model->insert (row, node.value);
+                    node.value = Value ();
+                    return true;
+                }
+                break;
+            }
+            case Remove: {
+                if (node.row >= 0 && node.row < model->pendingCount ()) {
+                    model->removeRange (node.row, node.count);
+                    return true;
+                }
+                break;
+            }
+            case Update: {
+                const int role = model->roleNames ().key (node.role, -1);
+                if (role >= 0 && node.row >= 0 && node.row < model->pendingCount ()) {
+                    model->setData (model->index (node.row, 0), node.data, role);
+                    return true;
+                }
+                break;
+            }
+        }
+        return false;
+    }
+
+private: // data members
+    QPointer<Model>        m_model;
+    QAtomicPointer<Node>   m_head;
+    QList<Node *>          m_backlog;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLMODELFEED_H
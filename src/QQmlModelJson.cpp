@@ -0,0 +1,189 @@
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+#include "QQmlModelJson.h"
+
+QQMLMODEL_USING_NAMESPACE;
+
+/*!
+    \internal
+    \details Size of the blocks read from the device.
+*/
+static const qint64 BLOCK_SIZE = 65536;
+
+/*!
+    \class QQmlModelJsonReader
+
+    \ingroup QT_QML_MODELS
+
+    \brief Splits a JSON array of objects read from a device or a buffer, one object at a time
+
+    \sa QQmlObjectListModel::appendFromJson()
+*/
+
+/*!
+    \details Constructs a reader of \a device, blocks are read on demand.
+*/
+QQmlModelJsonReader::QQmlModelJsonReader (QIODevice * device)
+    : m_device (device)
+    , m_pos (0)
+    , m_count (0)
+    , m_started (false)
+    , m_finished (false)
+    , m_error (device == Q_NULLPTR)
+{ }
+
+/*!
+    \details Constructs a reader of \a json, the buffer is shared and not copied.
+*/
+QQmlModelJsonReader::QQmlModelJsonReader (const QByteArray & json)
+    : m_device (Q_NULLPTR)
+    , m_buffer (json)
+    , m_pos (0)
+    , m_count (0)
+    , m_started (false)
+    , m_finished (false)
+    , m_error (false)
+{ }
+
+/*!
+    \internal
+    \details Appends the next block of the device to the buffer, dropping the bytes already consumed.
+
+    \return false when there is nothing left to read
+*/
+bool QQmlModelJsonReader::fill (void)
+{
+    if (m_device == Q_NULLPTR || m_device->atEnd ()) {
+        return false;
+    }
+    const QByteArray block = m_device->read (BLOCK_SIZE);
+    if (block.isEmpty ()) {
+        return false;
+    }
+    if (m_pos > 0) {
+        m_buffer.remove (0, m_pos);
+        m_pos = 0;
+    }
+    m_buffer.append (block);
+    return true;
+}
+
+/*!
+    \internal
+    \details Skips white spaces.
+
+    \return false when the input ended
+*/
+bool QQmlModelJsonReader::skipSpaces (void)
+{
+    forever {
+        while (m_pos < m_buffer.size ()) {
+            const char chr = m_buffer.at (m_pos);
+            if (chr != ' ' && chr != '\n' && chr != '\r' && chr != '\t') {
+                return true;
+            }
+            ++m_pos;
+        }
+        if (!fill ()) {
+            return false;
+        }
+    }
+}
+
+/*!
+    \details Finds the end of the next object by tracking the nesting depth outside of strings,
+    then parses only that object.
+
+    Objects must be separated by exactly one comma, like QJsonDocument requires : leading, doubled
+    and trailing commas are errors.
+
+    \return true with \a object set, false at the end of the array or on error
+*/
+bool QQmlModelJsonReader::readNext (QJsonObject & object)
+{
+    if (m_finished || m_error) {
+        return false;
+    }
+    if (!skipSpaces ()) {
+        m_error = true; // unterminated array
+        return false;
+    }
+    if (!m_started) {
+        if (m_buffer.at (m_pos) != '[') {
+            m_error = true;
+            return false;
+        }
+        m_started = true;
+        ++m_pos;
+        if (!skipSpaces ()) {
+            m_error = true;
+            return false;
+        }
+    }
+    if (m_buffer.at (m_pos) == ']') {
+        m_finished = true;
+        ++m_pos;
+        return false;
+    }
+    if (m_count > 0) {
+        if (m_buffer.at (m_pos) != ',') {
+            m_error = true;
+            return false;
+        }
+        ++m_pos;
+        if (!skipSpaces ()) {
+            m_error = true;
+            return false;
+        }
+    }
+    if (m_buffer.at (m_pos) != '{') { // also a trailing comma
+        m_error = true;
+        return false;
+    }
+    // Offsets are relative to the object start, the buffer may be compacted by fill ()
+    int end = 0;
+    int depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    forever {
+        if (m_pos + end >= m_buffer.size ()) {
+            if (!fill ()) {
+                m_error = true;
+                return false;
+            }
+            continue;
+        }
+        const char chr = m_buffer.at (m_pos + end++);
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            }
+            else if (chr == '\\') {
+                escaped = true;
+            }
+            else if (chr == '"') {
+                inString = false;
+            }
+        }
+        else if (chr == '"') {
+            inString = true;
+        }
+        else if (chr == '{' || chr == '[') {
+            ++depth;
+        }
+        else if ((chr == '}' || chr == ']') && --depth == 0) {
+            break;
+        }
+    }
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson (QByteArray::fromRawData (m_buffer.constData () + m_pos, end), &error);
+    m_pos += end;
+    if (error.error != QJsonParseError::NoError || !doc.isObject ()) {
+        m_error = true;
+        return false;
+    }
+    object = doc.object ();
+    ++m_count;
+    return true;
+}
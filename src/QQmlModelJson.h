@@ -0,0 +1,49 @@
+#ifndef QQMLMODELJSON_H
+#define QQMLMODELJSON_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonObject>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * Incremental reader of a JSON array of objects.
+ *
+ * The device is read by blocks and the array is split one object at a time,
+ * so only the current object is ever parsed by QJsonDocument : memory stays
+ * bounded by the largest object, not by the whole array.
+ */
+class QQMLMODEL_API_ QQmlModelJsonReader
+{
+public:
+    /** Read the array from device, which must be open */
+    explicit QQmlModelJsonReader (QIODevice * device);
+    /** Read the array from json */
+    explicit QQmlModelJsonReader (const QByteArray & json);
+
+    /** Read the next object of the array.
+     * \return false at the end of the array or on error, see hasError () */
+    bool readNext (QJsonObject & object);
+    /** Whether the input isn't an array of objects */
+    bool hasError (void) const { return m_error; }
+
+private:
+    bool fill (void);
+    bool skipSpaces (void);
+
+private:
+    QIODevice * m_device;
+    QByteArray  m_buffer;
+    int         m_pos;
+    int         m_count;
+    bool        m_started;
+    bool        m_finished;
+    bool        m_error;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLMODELJSON_H
@@ -0,0 +1,107 @@
+#ifndef QQMLMODELROWINDEX_H
+#define QQMLMODELROWINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * Item pointer to row index used by the object list models.
+ *
+ * Rows are renumbered lazily: every structural change only lowers the
+ * boundary under which stored rows are known to be valid, and the first
+ * lookup past that boundary renumbers the tail of the list once.
+ * Appending keeps the index valid, so lookups in a model that only grows at
+ * its end or that is only updated in place are always O(1).
+ *
+ * An item is expected to be in the model only once.
+ */
+class QQmlModelRowIndex
+{
+public:
+    QQmlModelRowIndex (void) : m_validUpTo (0) { }
+
+    void clear (void) {
+        m_rows.clear ();
+        m_validUpTo = 0;
+    }
+    void reserve (int size) {
+        m_rows.reserve (size);
+    }
+    bool contains (const QObject * item) const {
+        return (item != Q_NULLPTR && m_rows.contains (item));
+    }
+    /** Item was inserted at row, count is the size of the list after the insertion */
+    void insert (const QObject * item, int row, int count) {
+        if (item != Q_NULLPTR) {
+            m_rows.insert (item, row);
+            if (row == count -1 && m_validUpTo == row) {
+                m_validUpTo = count;
+            }
+            else {
+                invalidate (row);
+            }
+        }
+    }
+    /** Item was removed from row */
+    void remove (const QObject * item, int row) {
+        if (item != Q_NULLPTR) {
+            m_rows.remove (item);
+        }
+        invalidate (row);
+    }
+    /** An item was moved from src to dest */
+    void move (int src, int dest) {
+        invalidate (qMin (src, dest));
+    }
+    /** Every row from row to the end of the list may have changed */
+    void invalidate (int row) {
+        if (row < m_validUpTo) {
+            m_validUpTo = qMax (row, 0);
+        }
+    }
+    /** Row of item in list, -1 if item isn't in the list */
+    template<class List> int rowOf (const QObject * item, const List & list) const {
+        if (item == Q_NULLPTR) {
+            return -1;
+        }
+        typename QHash<const QObject *, int>::const_iterator it = m_rows.constFind (item);
+        if (it == m_rows.constEnd ()) {
+            return -1;
+        }
+        if (it.value () < m_validUpTo) {
+            return it.value ();
+        }
+        renumber (list);
+        return m_rows.value (item, -1);
+    }
+
+    static const QObject * keyOf (const QObject * item) {
+        return item;
+    }
+    template<class T> static const QObject * keyOf (const QSharedPointer<T> & item) {
+        return item.data ();
+    }
+
+private:
+    template<class List> void renumber (const List & list) const {
+        for (int row = m_validUpTo; row < list.size (); ++row) {
+            if (const QObject * item = keyOf (list.at (row))) {
+                m_rows.insert (item, row);
+            }
+        }
+        m_validUpTo = list.size ();
+    }
+
+private:
+    mutable int                       m_validUpTo;
+    mutable QHash<const QObject *, int> m_rows;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLMODELROWINDEX_H
@@ -0,0 +1,222 @@
+#ifndef QQMLMODELROWMAP_H
+#define QQMLMODELROWMAP_H
+
+#include <QVector>
+
+#include <algorithm>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * Sorted list of source rows used by the proxy models to map their rows.
+ *
+ * Rows are stored in chunks of a few hundred entries, each with an offset
+ * added to all of its entries. Shifting every source row after an insertion
+ * or a removal in the source only updates the offsets of the following
+ * chunks, and inserting or removing proxy rows only moves the entries of the
+ * chunks concerned, so the map is maintained in O(sqrt (n)) instead of O(n).
+ * Lookups are binary searches over the chunks then inside one chunk.
+ *
+ * Callers keep the entries sorted and unique.
+ */
+class QQmlModelRowMap
+{
+public:
+    QQmlModelRowMap (void) : m_count (0) { }
+
+    int count (void) const {
+        return m_count;
+    }
+    bool isEmpty (void) const {
+        return (m_count == 0);
+    }
+    void clear (void) {
+        m_chunks.clear ();
+        m_starts.clear ();
+        m_count = 0;
+    }
+    /** Source row at row, row must be valid */
+    int at (int row) const {
+        const int idx = chunkAt (row);
+        const Chunk & chunk = m_chunks.at (idx);
+        return (chunk.offset + chunk.rows.at (row - m_starts.at (idx)));
+    }
+    /** Source row at row, -1 if row is out of range */
+    int value (int row) const {
+        return (row >= 0 && row < m_count ? at (row) : -1);
+    }
+    /** Source rows of [row, row + count) */
+    QVector<int> mid (int row, int count) const {
+        QVector<int> ret;
+        ret.reserve (count);
+        for (int idx = 0; idx < count; ++idx) {
+            ret.append (at (row + idx));
+        }
+        return ret;
+    }
+    /** First row whose source row is sourceRow or after, count () if there is none */
+    int lowerBound (int sourceRow) const {
+        int lo = 0;
+        int hi = m_chunks.count ();
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            const Chunk & chunk = m_chunks.at (mid);
+            if (chunk.offset + chunk.rows.last () < sourceRow) {
+                lo = (mid +1);
+            }
+            else {
+                hi = mid;
+            }
+        }
+        if (lo == m_chunks.count ()) {
+            return m_count;
+        }
+        const Chunk & chunk = m_chunks.at (lo);
+        const int local = int (std::lower_bound (chunk.rows.constBegin (), chunk.rows.constEnd (), sourceRow - chunk.offset) - chunk.rows.constBegin ());
+        return (m_starts.at (lo) + local);
+    }
+    /** Append sourceRow, which must be after the last source row */
+    void append (int sourceRow) {
+        if (m_chunks.isEmpty () || m_chunks.last ().rows.count () >= chunkSize ()) {
+            m_chunks.append (Chunk ());
+            m_starts.append (m_count);
+        }
+        Chunk & chunk = m_chunks.last ();
+        chunk.rows.append (sourceRow - chunk.offset);
+        ++m_count;
+    }
+    /** Insert sourceRows at row, they must fit between the source rows around row */
+    void insert (int row, const QVector<int> & sourceRows) {
+        if (sourceRows.isEmpty ()) {
+            return;
+        }
+        if (row == m_count) {
+            for (QVector<int>::const_iterator it = sourceRows.constBegin (); it != sourceRows.constEnd (); ++it) {
+                append (* it);
+            }
+            return;
+        }
+        const int idx = chunkAt (row);
+        Chunk & chunk = m_chunks [idx];
+        const int local = (row - m_starts.at (idx));
+        chunk.rows.insert (local, sourceRows.count (), 0);
+        for (int pos = 0; pos < sourceRows.count (); ++pos) {
+            chunk.rows [local + pos] = (sourceRows.at (pos) - chunk.offset);
+        }
+        m_count += sourceRows.count ();
+        if (chunk.rows.count () > 2 * chunkSize ()) {
+            split (idx);
+        }
+        updateStarts (idx);
+    }
+    /** Remove count rows from row */
+    void remove (int row, int count) {
+        if (count <= 0) {
+            return;
+        }
+        int idx = chunkAt (row);
+        const int first = idx;
+        int local = (row - m_starts.at (idx));
+        int left = count;
+        while (left > 0) {
+            Chunk & chunk = m_chunks [idx];
+            const int removed = qMin (left, chunk.rows.count () - local);
+            chunk.rows.remove (local, removed);
+            left -= removed;
+            local = 0;
+            if (chunk.rows.isEmpty ()) {
+                m_chunks.remove (idx);
+                m_starts.remove (idx);
+            }
+            else {
+                ++idx;
+            }
+        }
+        m_count -= count;
+        if (first > 0) {
+            merge (first -1);
+        }
+        else if (first < m_chunks.count ()) {
+            merge (first);
+        }
+        updateStarts (qMax (first -1, 0));
+    }
+    /** Add delta to the source rows from row to the end */
+    void shift (int row, int delta) {
+        if (row >= m_count || delta == 0) {
+            return;
+        }
+        int idx = chunkAt (row);
+        const int local = (row - m_starts.at (idx));
+        if (local > 0) {
+            Chunk & chunk = m_chunks [idx];
+            for (int pos = local; pos < chunk.rows.count (); ++pos) {
+                chunk.rows [pos] += delta;
+            }
+            ++idx;
+        }
+        for (; idx < m_chunks.count (); ++idx) {
+            m_chunks [idx].offset += delta;
+        }
+    }
+
+private:
+    struct Chunk {
+        Chunk (void) : offset (0) { }
+
+        int          offset;
+        QVector<int> rows;
+    };
+
+    static int chunkSize (void) {
+        return 256;
+    }
+    /** Chunk holding row, the last one when row is count () */
+    int chunkAt (int row) const {
+        const int idx = int (std::upper_bound (m_starts.constBegin (), m_starts.constEnd (), row) - m_starts.constBegin ());
+        return (idx -1);
+    }
+    void updateStarts (int idx) {
+        int start = (idx > 0 ? m_starts.at (idx -1) + m_chunks.at (idx -1).rows.count () : 0);
+        for (; idx < m_chunks.count (); ++idx) {
+            m_starts [idx] = start;
+            start += m_chunks.at (idx).rows.count ();
+        }
+    }
+    /** Cut the chunk at idx in chunks of chunkSize () entries, starts must be updated after */
+    void split (int idx) {
+        const Chunk whole = m_chunks.at (idx);
+        const int pieces = ((whole.rows.count () + chunkSize () -1) / chunkSize ());
+        m_chunks [idx].rows = whole.rows.mid (0, chunkSize ());
+        for (int piece = 1; piece < pieces; ++piece) {
+            Chunk chunk;
+            chunk.offset = whole.offset;
+            chunk.rows = whole.rows.mid (piece * chunkSize (), chunkSize ());
+            m_chunks.insert (idx + piece, chunk);
+            m_starts.insert (idx + piece, 0);
+        }
+    }
+    /** Merge the chunk at idx with the next one when both fit in one, starts must be updated after */
+    void merge (int idx) {
+        if (idx +1 < m_chunks.count () && m_chunks.at (idx).rows.count () + m_chunks.at (idx +1).rows.count () <= chunkSize ()) {
+            Chunk & chunk = m_chunks [idx];
+            const Chunk & next = m_chunks.at (idx +1);
+            const int delta = (next.offset - chunk.offset);
+            for (QVector<int>::const_iterator it = next.rows.constBegin (); it != next.rows.constEnd (); ++it) {
+                chunk.rows.append (* it + delta);
+            }
+            m_chunks.remove (idx +1);
+            m_starts.remove (idx +1);
+        }
+    }
+
+    QVector<Chunk> m_chunks;
+    QVector<int>   m_starts;
+    int            m_count;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLMODELROWMAP_H
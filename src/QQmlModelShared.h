@@ -1,6 +1,7 @@
 #ifndef QQMLMODELSHARED_H
 #define QQMLMODELSHARED_H
 
+#include <QPointer>
 #include <QQmlEngine>
 #include <QtQml>
 
@@ -31,6 +32,22 @@
 #define QQMLMODEL_USING_NAMESPACE
 #endif
 
+/**
+ * \internal
+ * Members of the lazy model property macros : the model is created with the owner as parent on the
+ * first Get##Name() call. The QPointer also forgets a model deleted from elsewhere.
+ */
+#define QQMLMODEL_LAZY_PROPERTY_IMPL(type, name, Name) \
+    private: mutable QPointer<type> _##name; \
+    public: type * Get##Name (void) const { \
+        if (_##name.isNull ()) { \
+            _##name = new type (const_cast<QObject *> (static_cast<const QObject *> (this))); \
+        } \
+        return _##name.data (); \
+    } \
+    public: bool Has##Name (void) const { return !_##name.isNull (); } \
+    private:
+
 QQMLMODEL_NAMESPACE_START
 
 class QQMLMODEL_API_ QQmlModelVersion
@@ -48,6 +65,37 @@ public:
 	static QString getVersion();
 };
 
+/**
+ * RAII batch on a model: calls beginBatch() on construction and endBatch() on destruction.
+ * Works with every model of the library providing beginBatch()/endBatch().
+ *
+ * \code
+ * {
+ *     QQmlModelBatch<QQmlObjectListModelBase> batch (model);
+ *     for (...)
+ *         model->append (item);
+ * } // one insert notification and one countChanged here
+ * \endcode
+ */
+template<class Model> class QQmlModelBatch
+{
+public:
+	explicit QQmlModelBatch (Model * model) : m_model (model)
+	{
+		if (m_model)
+			m_model->beginBatch ();
+	}
+	~QQmlModelBatch ()
+	{
+		if (m_model)
+			m_model->endBatch ();
+	}
+
+private:
+	Q_DISABLE_COPY (QQmlModelBatch)
+	Model * m_model;
+};
+
 	//static void registerQtQmlTricksSmartDataModel(QQmlEngine* engine);
 
 QQMLMODEL_NAMESPACE_END
@@ -0,0 +1,112 @@
+#ifndef QQMLMODELSNAPSHOT_H
+#define QQMLMODELSNAPSHOT_H
+
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QThread>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * \internal
+ * Keeps a copy of the items of a pinned snapshot. It lives on the thread the snapshot was taken on,
+ * and is deleted there whichever thread releases the last copy of the snapshot.
+ */
+template<class T> class QQmlModelSnapshotKeeper : public QObject
+{
+public:
+    explicit QQmlModelSnapshotKeeper (const QList<T> & items) : m_items (items) { }
+
+    /** Deleter of the keeper : delete now on its thread, post the deletion there otherwise */
+    static void release (QObject * keeper) {
+        if (keeper->thread () == QThread::currentThread ()) {
+            delete keeper;
+        }
+        else {
+            keeper->deleteLater ();
+        }
+    }
+
+private:
+    QList<T> m_items;
+};
+
+/**
+ * Immutable view of the items of a model at one point in time.
+ *
+ * A snapshot shares the item array of the model : taking it only increments
+ * a reference count, and the next mutation of the model copies the array
+ * instead of changing the shared one. A snapshot can then be passed to any
+ * thread and read without locking while the model keeps changing, as long as
+ * it's taken on the thread of the model.
+ *
+ * Only the array is frozen, not the items : a snapshot of a
+ * QQmlSharedObjectListModel keeps its items alive, while the items of a
+ * QQmlObjectListModel snapshot are raw pointers that the model deletes when
+ * it owns them and they are removed.
+ *
+ * A snapshot that keeps QObjects alive is pinned() to the thread it was taken
+ * on : when a worker thread drops the last copy, the items are released by
+ * the event loop of that thread, never on the worker. Item pointers copied
+ * out of the snapshot aren't covered and must be dropped before it.
+ */
+template<class T> class QQmlModelSnapshot
+{
+public:
+    typedef typename QList<T>::const_iterator const_iterator;
+
+    QQmlModelSnapshot (void) { }
+    explicit QQmlModelSnapshot (const QList<T> & items) : m_items (items) { }
+
+    /** Snapshot of items whose last reference is released on the current thread, see QQmlModelSnapshotKeeper */
+    static QQmlModelSnapshot pinned (const QList<T> & items) {
+        QQmlModelSnapshot ret (items);
+        ret.m_keeper = QSharedPointer<QObject> (new QQmlModelSnapshotKeeper<T> (items), &QQmlModelSnapshotKeeper<T>::release);
+        return ret;
+    }
+
+    int count (void) const {
+        return m_items.count ();
+    }
+    int size (void) const {
+        return m_items.count ();
+    }
+    bool isEmpty (void) const {
+        return m_items.isEmpty ();
+    }
+    /** Item at idx, idx must be valid */
+    const T & at (int idx) const {
+        return m_items.at (idx);
+    }
+    /** Item at idx, defaultValue if idx is out of range */
+    T value (int idx, const T & defaultValue = T ()) const {
+        return m_items.value (idx, defaultValue);
+    }
+    const_iterator begin (void) const {
+        return m_items.constBegin ();
+    }
+    const_iterator end (void) const {
+        return m_items.constEnd ();
+    }
+    const_iterator constBegin (void) const {
+        return m_items.constBegin ();
+    }
+    const_iterator constEnd (void) const {
+        return m_items.constEnd ();
+    }
+    /** The items as a list, sharing the same array */
+    const QList<T> & toList (void) const {
+        return m_items;
+    }
+
+private:
+    QSharedPointer<QObject> m_keeper; // declared first, so that m_items is dropped before it
+    QList<T>                m_items;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLMODELSNAPSHOT_H
@@ -0,0 +1,83 @@
+#include <QDateTime>
+
+#include "QQmlModelSort.h"
+
+QQMLMODEL_USING_NAMESPACE;
+
+/*!
+    \internal
+    \details Whether \a type is compared as a number.
+*/
+static bool isNumeric (int type)
+{
+    switch (type) {
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::Long:
+        case QMetaType::ULong:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Char:
+        case QMetaType::SChar:
+        case QMetaType::UChar:
+        case QMetaType::Float:
+        case QMetaType::Double:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*!
+    \internal
+*/
+template<class T> static int compareValues (const T & a, const T & b)
+{
+    return (a < b ? -1 : (b < a ? 1 : 0));
+}
+
+/*!
+    \details Compares two role values for sorting.
+
+    Invalid values come first. Integers are compared as 64 bits integers, other numbers as doubles,
+    dates and times chronologically, and every other type by its string conversion.
+
+    \return A negative value if \a a comes before \a b, a positive one if it comes after, 0 if they are equivalent
+*/
+int QQmlModelSort::compare (const QVariant & a, const QVariant & b)
+{
+    if (!a.isValid () || !b.isValid ()) {
+        return (a.isValid () ? 1 : (b.isValid () ? -1 : 0));
+    }
+    const int typeA = a.userType ();
+    const int typeB = b.userType ();
+    if (isNumeric (typeA) && isNumeric (typeB)) {
+        const bool real = (typeA == QMetaType::Float || typeA == QMetaType::Double ||
+                           typeB == QMetaType::Float || typeB == QMetaType::Double);
+        if (real) {
+            return compareValues (a.toDouble (), b.toDouble ());
+        }
+        else if (typeA == QMetaType::ULongLong || typeB == QMetaType::ULongLong) {
+            return compareValues (a.toULongLong (), b.toULongLong ());
+        }
+        return compareValues (a.toLongLong (), b.toLongLong ());
+    }
+    if (typeA == typeB) {
+        switch (typeA) {
+            case QMetaType::QString:
+                return a.toString ().compare (b.toString ());
+            case QMetaType::QDateTime:
+                return compareValues (a.toDateTime (), b.toDateTime ());
+            case QMetaType::QDate:
+                return compareValues (a.toDate (), b.toDate ());
+            case QMetaType::QTime:
+                return compareValues (a.toTime (), b.toTime ());
+            default:
+                break;
+        }
+    }
+    return a.toString ().compare (b.toString ());
+}
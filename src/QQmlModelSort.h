@@ -0,0 +1,115 @@
+#ifndef QQMLMODELSORT_H
+#define QQMLMODELSORT_H
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QVariant>
+#include <QVector>
+
+#include <algorithm>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * Sort helpers shared by the list models.
+ *
+ * Models never sort their storage directly : they sort a permutation of
+ * their rows (permutation [newRow] = oldRow), so that the comparison can work
+ * on keys extracted once per row and the persistent indexes can be remapped
+ * afterwards. The sort is stable, items comparing equal keep their order.
+ */
+class QQMLMODEL_API_ QQmlModelSort
+{
+public:
+    /** Minimum number of rows sorted by each thread of a parallel sort */
+    static int minChunkSize (void) { return 16384; }
+
+    /** Compare two role values like strcmp does. Invalid values come first,
+     * numbers are compared as numbers, other types by their string conversion */
+    static int compare (const QVariant & a, const QVariant & b);
+
+    /** Orders rows by keys extracted once per row, stride keys per row */
+    class KeyLessThan
+    {
+    public:
+        KeyLessThan (const QVector<QVariant> & keys, int stride, Qt::SortOrder order)
+            : m_keys (&keys), m_stride (stride), m_order (order) { }
+
+        bool operator() (int a, int b) const {
+            const QVariant * keyA = (m_keys->constData () + a * m_stride);
+            const QVariant * keyB = (m_keys->constData () + b * m_stride);
+            for (int idx = 0; idx < m_stride; ++idx) {
+                const int cmp = compare (keyA [idx], keyB [idx]);
+                if (cmp != 0) {
+                    return (m_order == Qt::AscendingOrder ? cmp < 0 : cmp > 0);
+                }
+            }
+            return false;
+        }
+
+    private:
+        const QVector<QVariant> * m_keys;
+        int                       m_stride;
+        Qt::SortOrder             m_order;
+    };
+
+    /** Stable sort of the rows [0, count) with lessThan (rowA, rowB).
+     * When parallel is true and the list is large enough, chunks are sorted on the global
+     * thread pool then merged, lessThan must then be safe to call from several threads.
+     * \return permutation such as permutation [newRow] = oldRow */
+    template<class LessThan> static QVector<int> permutation (int count, LessThan lessThan, bool parallel) {
+        QVector<int> ret (count);
+        for (int row = 0; row < count; ++row) {
+            ret [row] = row;
+        }
+        const int chunks = (parallel ? qMin (QThread::idealThreadCount (), count / minChunkSize ()) : 1);
+        if (chunks < 2) {
+            std::stable_sort (ret.begin (), ret.end (), lessThan);
+            return ret;
+        }
+        int * data = ret.data ();
+        QVector<int> bounds (chunks +1);
+        for (int idx = 0; idx <= chunks; ++idx) {
+            bounds [idx] = int ((qint64 (count) * idx) / chunks);
+        }
+        QSemaphore done;
+        for (int idx = 1; idx < chunks; ++idx) {
+            QThreadPool::globalInstance ()->start (new Chunk<LessThan> (data + bounds.at (idx), data + bounds.at (idx +1), lessThan, &done));
+        }
+        std::stable_sort (data, data + bounds.at (1), lessThan);
+        done.acquire (chunks -1);
+        for (int width = 1; width < chunks; width *= 2) {
+            for (int idx = 0; idx + width < chunks; idx += 2 * width) {
+                std::inplace_merge (data + bounds.at (idx), data + bounds.at (idx + width), data + bounds.at (qMin (idx + 2 * width, chunks)), lessThan);
+            }
+        }
+        return ret;
+    }
+
+private:
+    template<class LessThan> class Chunk : public QRunnable
+    {
+    public:
+        Chunk (int * first, int * last, LessThan lessThan, QSemaphore * done)
+            : m_first (first), m_last (last), m_lessThan (lessThan), m_done (done) { }
+
+        void run (void) Q_DECL_OVERRIDE {
+            std::stable_sort (m_first, m_last, m_lessThan);
+            m_done->release ();
+        }
+
+    private:
+        int *        m_first;
+        int *        m_last;
+        LessThan     m_lessThan;
+        QSemaphore * m_done;
+    };
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLMODELSORT_H
@@ -0,0 +1,418 @@
+#ifndef QQMLOBJECTLISTFILTERMODEL_H
+#define QQMLOBJECTLISTFILTERMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QDebug>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QVariant>
+#include <QVector>
+
+#include <functional>
+
+#include "QQmlModelRowMap.h"
+#include "QQmlModelShared.h"
+#include "QQmlObjectListModel.h"
+
+QQMLMODEL_NAMESPACE_START
+
+class QQmlObjectListFilterModelBase : public QAbstractListModel { // abstract Qt base class
+    Q_OBJECT
+    Q_PROPERTY (int count READ count NOTIFY countChanged)
+    Q_PROPERTY (int length READ count NOTIFY countChanged)
+
+public:
+    explicit QQmlObjectListFilterModelBase (QObject * parent = Q_NULLPTR) : QAbstractListModel (parent) { }
+
+public slots: // virtual methods API for QML
+	/** Returns the number of items accepted by the filter */
+	virtual int count (void) const = 0;
+	/** Returns the accepted item at row */
+	virtual QObject * get (int row) const = 0;
+	/** Row in the source model of the accepted item at row, -1 if row is out of range */
+	virtual int mapToSource (int row) const = 0;
+	/** Row of the item at sourceRow in the source model, -1 if it isn't accepted */
+	virtual int mapFromSource (int sourceRow) const = 0;
+	/** Evaluate the filter again on every row of the source model, ie when the predicate
+	 * depends on something else than the item roles */
+	virtual void invalidateFilter (void) = 0;
+
+protected slots: // source model callbacks
+    virtual void onSourceDataChanged (const QModelIndex & topLeft, const QModelIndex & bottomRight, const QVector<int> & roles) = 0;
+    virtual void onSourceRowsInserted (const QModelIndex & parent, int first, int last) = 0;
+    virtual void onSourceRowsAboutToBeRemoved (const QModelIndex & parent, int first, int last) = 0;
+    virtual void onSourceRowsRemoved (const QModelIndex & parent, int first, int last) = 0;
+    virtual void onSourceRowsAboutToBeMoved (const QModelIndex & parent, int first, int last, const QModelIndex & destination, int row) = 0;
+    virtual void onSourceRowsMoved (const QModelIndex & parent, int first, int last, const QModelIndex & destination, int row) = 0;
+    virtual void onSourceLayoutAboutToBeChanged (void) = 0;
+    virtual void onSourceLayoutChanged (void) = 0;
+    virtual void onSourceModelAboutToBeReset (void) = 0;
+    virtual void onSourceModelReset (void) = 0;
+
+signals: // notifier
+	/** Emitted when count changed (ie accepted items were inserted or removed) */
+    void countChanged (void);
+};
+
+/**
+ * Filter proxy over a QQmlObjectListModel<ItemType>, with a typed C++ predicate.
+ *
+ * Unlike QSortFilterProxyModel the predicate gets the item itself, and a
+ * dataChanged of the source only evaluates the changed rows again, and only
+ * when one of the roles the filter depends on changed. The proxy keeps the
+ * source order and maps its rows with a QQmlModelRowMap, rows entering or
+ * leaving the filter are notified as contiguous runs and rows moved in the
+ * source are moved in the proxy, without a layout change.
+ *
+ * \code
+ * QQmlObjectListFilterModel<Contact> online;
+ * online.setSourceModel (contacts);
+ * online.setFilter ([] (Contact * contact) { return contact->isOnline (); }, QList<QByteArray> () << "online");
+ * \endcode
+ */
+template<class ItemType> class QQmlObjectListFilterModel : public QQmlObjectListFilterModelBase
+{
+public:
+    typedef std::function<bool (ItemType *)> Predicate;
+
+    explicit QQmlObjectListFilterModel (QObject * parent = Q_NULLPTR)
+        : QQmlObjectListFilterModelBase (parent)
+        , m_count (0)
+        , m_moving (false)
+    { }
+    QVariant data (const QModelIndex & index, int role) const Q_DECL_FINAL {
+        QVariant ret;
+        const int sourceRow = mapToSource (index.row ());
+        if (sourceRow >= 0) {
+            ret = m_source->data (m_source->index (sourceRow, 0, noParent ()), role);
+        }
+        return ret;
+    }
+    bool setData (const QModelIndex & index, const QVariant & value, int role) Q_DECL_FINAL {
+        bool ret = false;
+        const int sourceRow = mapToSource (index.row ());
+        if (sourceRow >= 0) {
+            ret = m_source->setData (m_source->index (sourceRow, 0, noParent ()), value, role);
+        }
+        return ret;
+    }
+    QHash<int, QByteArray> roleNames (void) const Q_DECL_FINAL {
+        return (m_source ? m_source->roleNames () : QHash<int, QByteArray> ());
+    }
+    int rowCount (const QModelIndex & parent = QModelIndex ()) const Q_DECL_FINAL {
+        Q_UNUSED (parent);
+        return m_sourceRows.count ();
+    }
+
+public: // C++ API
+    QQmlObjectListModel<ItemType> * sourceModel (void) const {
+        return m_source.data ();
+    }
+    /** Filter the items of model, that must outlive the proxy or be destroyed with it */
+    void setSourceModel (QQmlObjectListModel<ItemType> * model) {
+        if (m_source.data () == model) {
+            return;
+        }
+        beginResetModel ();
+        if (m_source) {
+            disconnect (m_source.data (), Q_NULLPTR, this, Q_NULLPTR);
+        }
+        m_source = model;
+        if (m_source) {
+            connect (m_source.data (), &QAbstractItemModel::dataChanged,             this, &QQmlObjectListFilterModel::onSourceDataChanged);
+            connect (m_source.data (), &QAbstractItemModel::rowsInserted,            this, &QQmlObjectListFilterModel::onSourceRowsInserted);
+            connect (m_source.data (), &QAbstractItemModel::rowsAboutToBeRemoved,    this, &QQmlObjectListFilterModel::onSourceRowsAboutToBeRemoved);
+            connect (m_source.data (), &QAbstractItemModel::rowsRemoved,             this, &QQmlObjectListFilterModel::onSourceRowsRemoved);
+            connect (m_source.data (), &QAbstractItemModel::layoutAboutToBeChanged,  this, &QQmlObjectListFilterModel::onSourceLayoutAboutToBeChanged);
+            connect (m_source.data (), &QAbstractItemModel::layoutChanged,           this, &QQmlObjectListFilterModel::onSourceLayoutChanged);
+            connect (m_source.data (), &QAbstractItemModel::rowsAboutToBeMoved,      this, &QQmlObjectListFilterModel::onSourceRowsAboutToBeMoved);
+            connect (m_source.data (), &QAbstractItemModel::rowsMoved,               this, &QQmlObjectListFilterModel::onSourceRowsMoved);
+            connect (m_source.data (), &QAbstractItemModel::modelAboutToBeReset,     this, &QQmlObjectListFilterModel::onSourceModelAboutToBeReset);
+            connect (m_source.data (), &QAbstractItemModel::modelReset,              this, &QQmlObjectListFilterModel::onSourceModelReset);
+        }
+        resolveRoles ();
+        filterAll ();
+        endResetModel ();
+        updateCounter ();
+    }
+    /** Set the predicate accepting items, every item is accepted when it is empty.
+     * \param dependentRoles Names of the roles the predicate reads. A change of another role
+     * never evaluates the predicate again. When empty, any role change does. */
+    void setFilter (Predicate predicate, const QList<QByteArray> & dependentRoles = QList<QByteArray> ()) {
+        m_predicate = predicate;
+        m_dependentRoleNames = dependentRoles;
+        resolveRoles ();
+        invalidateFilter ();
+    }
+    ItemType * at (int row) const {
+        const int sourceRow = mapToSource (row);
+        return (sourceRow >= 0 ? sourceItem (sourceRow) : Q_NULLPTR);
+    }
+	int count (void) const Q_DECL_FINAL {
+        return m_sourceRows.count ();
+    }
+	QObject * get (int row) const Q_DECL_FINAL {
+        return at (row);
+    }
+	int mapToSource (int row) const Q_DECL_FINAL {
+        return m_sourceRows.value (row);
+    }
+	int mapFromSource (int sourceRow) const Q_DECL_FINAL {
+        const int row = m_sourceRows.lowerBound (sourceRow);
+        return (row < m_sourceRows.count () && m_sourceRows.at (row) == sourceRow ? row : -1);
+    }
+	void invalidateFilter (void) Q_DECL_FINAL {
+        if (m_source) {
+            refilter (0, m_source->rowCount () -1, false);
+        }
+    }
+
+protected: // source model callbacks
+    void onSourceDataChanged (const QModelIndex & topLeft, const QModelIndex & bottomRight, const QVector<int> & roles) Q_DECL_FINAL {
+        bool dependent = (roles.isEmpty () || m_dependentRoles.isEmpty ());
+        for (QVector<int>::const_iterator it = roles.constBegin (); it != roles.constEnd () && !dependent; ++it) {
+            dependent = m_dependentRoles.contains (* it);
+        }
+        if (dependent) {
+            refilter (topLeft.row (), bottomRight.row (), true, roles);
+        }
+        else {
+            forwardDataChanged (topLeft.row (), bottomRight.row (), roles);
+        }
+    }
+    void onSourceRowsInserted (const QModelIndex & parent, int first, int last) Q_DECL_FINAL {
+        Q_UNUSED (parent);
+        const int row = m_sourceRows.lowerBound (first);
+        m_sourceRows.shift (row, last - first +1);
+        QVector<int> accepted;
+        for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+            if (accepts (sourceRow)) {
+                accepted.append (sourceRow);
+            }
+        }
+        if (!accepted.isEmpty ()) {
+            // New source rows are contiguous, so are the accepted ones in the proxy
+            beginInsertRows (noParent (), row, row + accepted.count () -1);
+            m_sourceRows.insert (row, accepted);
+            endInsertRows ();
+            updateCounter ();
+        }
+    }
+    void onSourceRowsAboutToBeRemoved (const QModelIndex & parent, int first, int last) Q_DECL_FINAL {
+        Q_UNUSED (parent);
+        const int row = m_sourceRows.lowerBound (first);
+        const int end = m_sourceRows.lowerBound (last +1);
+        if (end > row) {
+            beginRemoveRows (noParent (), row, end -1);
+            m_sourceRows.remove (row, end - row);
+            endRemoveRows ();
+            updateCounter ();
+        }
+    }
+    void onSourceRowsRemoved (const QModelIndex & parent, int first, int last) Q_DECL_FINAL {
+        Q_UNUSED (parent);
+        m_sourceRows.shift (m_sourceRows.lowerBound (first), -(last - first +1));
+    }
+    void onSourceRowsAboutToBeMoved (const QModelIndex & parent, int first, int last, const QModelIndex & destination, int row) Q_DECL_FINAL {
+        Q_UNUSED (parent);
+        Q_UNUSED (destination);
+        // Accepted rows keep their order when none of them is moved, or when they land next to themselves
+        const int begin = m_sourceRows.lowerBound (first);
+        const int end = m_sourceRows.lowerBound (last +1);
+        const int dest = m_sourceRows.lowerBound (row);
+        m_moving = (end > begin && (dest < begin || dest > end));
+        if (m_moving) {
+            beginMoveRows (noParent (), begin, end -1, noParent (), dest);
+        }
+    }
+    void onSourceRowsMoved (const QModelIndex & parent, int first, int last, const QModelIndex & destination, int row) Q_DECL_FINAL {
+        Q_UNUSED (parent);
+        Q_UNUSED (destination);
+        // Arguments are the ones of the move, the row map still holds the source rows from before it
+        const int count = (last - first +1);
+        const int begin = m_sourceRows.lowerBound (first);
+        const int end = m_sourceRows.lowerBound (last +1);
+        const int dest = m_sourceRows.lowerBound (row);
+        QVector<int> moved = m_sourceRows.mid (begin, end - begin);
+        const int delta = (row > last ? row - last -1 : row - first);
+        for (QVector<int>::iterator it = moved.begin (); it != moved.end (); ++it) {
+            * it += delta;
+        }
+        m_sourceRows.remove (begin, end - begin);
+        if (row > last) {
+            // Rows between the moved ones and the destination go up by count
+            const int stop = (dest - (end - begin));
+            m_sourceRows.shift (begin, -count);
+            m_sourceRows.shift (stop, count);
+            m_sourceRows.insert (stop, moved);
+        }
+        else {
+            // Rows between the destination and the moved ones go down by count
+            m_sourceRows.shift (dest, count);
+            m_sourceRows.shift (begin, -count);
+            m_sourceRows.insert (dest, moved);
+        }
+        if (m_moving) {
+            m_moving = false;
+            endMoveRows ();
+        }
+    }
+    void onSourceLayoutAboutToBeChanged (void) Q_DECL_FINAL {
+        emit layoutAboutToBeChanged ();
+        m_layoutItems.clear ();
+        m_layoutItems.reserve (m_sourceRows.count ());
+        for (int row = 0; row < m_sourceRows.count (); ++row) {
+            m_layoutItems.append (sourceItem (m_sourceRows.at (row)));
+        }
+    }
+    void onSourceLayoutChanged (void) Q_DECL_FINAL {
+        // Accepted items stay accepted, only their order changes
+        QHash<const QObject *, int> oldRows;
+        oldRows.reserve (m_layoutItems.count ());
+        for (int row = 0; row < m_layoutItems.count (); ++row) {
+            oldRows.insert (m_layoutItems.at (row), row);
+        }
+        QVector<int> newRows (m_layoutItems.count (), -1);
+        m_sourceRows.clear ();
+        const int sourceCount = m_source->rowCount ();
+        for (int sourceRow = 0; sourceRow < sourceCount; ++sourceRow) {
+            const int oldRow = oldRows.value (sourceItem (sourceRow), -1);
+            if (oldRow >= 0) {
+                newRows [oldRow] = m_sourceRows.count ();
+                m_sourceRows.append (sourceRow);
+            }
+        }
+        m_layoutItems.clear ();
+        const QModelIndexList from = persistentIndexList ();
+        QModelIndexList to;
+        to.reserve (from.count ());
+        for (QModelIndexList::const_iterator it = from.constBegin (); it != from.constEnd (); ++it) {
+            to.append (QAbstractListModel::index (newRows.value (it->row (), -1), it->column (), noParent ()));
+        }
+        changePersistentIndexList (from, to);
+        emit layoutChanged ();
+    }
+    void onSourceModelAboutToBeReset (void) Q_DECL_FINAL {
+        beginResetModel ();
+    }
+    void onSourceModelReset (void) Q_DECL_FINAL {
+        filterAll ();
+        endResetModel ();
+        updateCounter ();
+    }
+
+protected: // internal stuff
+    static const QModelIndex & noParent (void) {
+        static const QModelIndex ret = QModelIndex ();
+        return ret;
+    }
+    /** Item at sourceRow as the views of the source know it, ie even while the source commits a batch */
+    ItemType * sourceItem (int sourceRow) const {
+        return m_source->visibleItems ().value (sourceRow);
+    }
+    bool accepts (int sourceRow) const {
+        if (!m_predicate) {
+            return true;
+        }
+        ItemType * item = sourceItem (sourceRow);
+        return (item != Q_NULLPTR && m_predicate (item));
+    }
+    void resolveRoles (void) {
+        m_dependentRoles.clear ();
+        if (m_source) {
+            for (QList<QByteArray>::const_iterator it = m_dependentRoleNames.constBegin (); it != m_dependentRoleNames.constEnd (); ++it) {
+                const int role = m_source->roleForName (* it);
+                if (role >= 0) {
+                    m_dependentRoles.append (role);
+                }
+                else {
+                    qWarning () << "QQmlObjectListFilterModel : Unknown dependent role" << * it;
+                }
+            }
+        }
+    }
+    void filterAll (void) {
+        m_sourceRows.clear ();
+        const int sourceCount = (m_source ? m_source->rowCount () : 0);
+        for (int sourceRow = 0; sourceRow < sourceCount; ++sourceRow) {
+            if (accepts (sourceRow)) {
+                m_sourceRows.append (sourceRow);
+            }
+        }
+    }
+    /** Evaluate the source rows [first, last] again. Runs of rows entering or leaving the filter
+     * are inserted or removed at once, when forward is true rows staying accepted get dataChanged */
+    void refilter (int first, int last, bool forward, const QVector<int> & roles = QVector<int> ()) {
+        const int count = (last - first +1);
+        if (count <= 0) {
+            return;
+        }
+        QVector<bool> wasAccepted (count, false);
+        for (int row = m_sourceRows.lowerBound (first); row < m_sourceRows.count () && m_sourceRows.at (row) <= last; ++row) {
+            wasAccepted [m_sourceRows.at (row) - first] = true;
+        }
+        QVector<bool> isAccepted (count, false);
+        for (int idx = 0; idx < count; ++idx) {
+            isAccepted [idx] = accepts (first + idx);
+        }
+        int idx = 0;
+        while (idx < count) {
+            int end = (idx +1);
+            while (end < count && wasAccepted.at (end) == wasAccepted.at (idx) && isAccepted.at (end) == isAccepted.at (idx)) {
+                ++end;
+            }
+            const int row = m_sourceRows.lowerBound (first + idx);
+            const int runCount = (end - idx);
+            if (wasAccepted.at (idx) && isAccepted.at (idx)) {
+                if (forward) {
+                    emit dataChanged (QAbstractListModel::index (row, 0, noParent ()), QAbstractListModel::index (row + runCount -1, 0, noParent ()), roles);
+                }
+            }
+            else if (isAccepted.at (idx)) {
+                beginInsertRows (noParent (), row, row + runCount -1);
+                QVector<int> inserted (runCount);
+                for (int offset = 0; offset < runCount; ++offset) {
+                    inserted [offset] = (first + idx + offset);
+                }
+                m_sourceRows.insert (row, inserted);
+                endInsertRows ();
+            }
+            else if (wasAccepted.at (idx)) {
+                beginRemoveRows (noParent (), row, row + runCount -1);
+                m_sourceRows.remove (row, runCount);
+                endRemoveRows ();
+            }
+            idx = end;
+        }
+        updateCounter ();
+    }
+    void forwardDataChanged (int first, int last, const QVector<int> & roles) {
+        const int row = m_sourceRows.lowerBound (first);
+        const int end = m_sourceRows.lowerBound (last +1);
+        if (end > row) {
+            emit dataChanged (QAbstractListModel::index (row, 0, noParent ()), QAbstractListModel::index (end -1, 0, noParent ()), roles);
+        }
+    }
+    void updateCounter (void) {
+        if (m_count != m_sourceRows.count ()) {
+            m_count = m_sourceRows.count ();
+            emit countChanged ();
+        }
+    }
+
+private: // data members
+    int                                       m_count;
+    bool                                      m_moving;
+    QPointer<QQmlObjectListModel<ItemType> >  m_source;
+    Predicate                                 m_predicate;
+    QList<QByteArray>                         m_dependentRoleNames;
+    QVector<int>                              m_dependentRoles;
+    QQmlModelRowMap                           m_sourceRows;
+    QList<ItemType *>                         m_layoutItems;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLOBJECTLISTFILTERMODEL_H
@@ -4,42 +4,42 @@
 #include <QAbstractListModel>
 #include <QByteArray>
 #include <QChar>
+#include <QDataStream>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
 #include <QList>
 #include <QMetaMethod>
 #include <QMetaObject>
 #include <QMetaProperty>
 #include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
 #include <QString>
 #include <QStringBuilder>
+#include <QStringList>
+#include <QThread>
 #include <QVariant>
+#include <QSet>
 #include <QVector>
 
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "QQmlModelArchive.h"
+#include "QQmlModelJson.h"
 #include "QQmlModelShared.h"
+#include "QQmlModelSnapshot.h"
+#include "QQmlObjectRoleTable.h"
+#include "QQmlPointerListModel.h"
 
 QQMLMODEL_NAMESPACE_START
 
-template<typename T> QList<T> qListFromVariant (const QVariantList & list) {
-    QList<T> ret;
-    ret.reserve (list.size ());
-    for (QVariantList::const_iterator it = list.constBegin (); it != list.constEnd (); ++it) {
-        const QVariant & var = static_cast<QVariant>(* it);
-        ret.append (var.value<T> ());
-    }
-    return ret;
-}
-
-template<typename T> QVariantList qListToVariant (const QList<T> & list) {
-    QVariantList ret;
-    ret.reserve (list.size ());
-    for (typename QList<T>::const_iterator it = list.constBegin (); it != list.constEnd (); ++it) {
-        const T & val = static_cast<T>(* it);
-        ret.append (QVariant::fromValue (val));
-    }
-    return ret;
-}
-
 // custom foreach for QList, which uses no copy and check pointer non-null
 #define FOREACH_PTR_IN_QLIST(_type_, _var_, _list_) \
     for (typename QList<_type_ *>::const_iterator it = _list_.constBegin (); it != _list_.constEnd (); ++it) \
@@ -49,9 +49,49 @@ class QQmlObjectListModelBase : public QAbstractListModel { // abstract Qt base
     Q_OBJECT
     Q_PROPERTY (int count READ count NOTIFY countChanged)
     Q_PROPERTY (int length READ count NOTIFY countChanged)
+    Q_PROPERTY (bool coalesceDataChanged READ coalesceDataChanged WRITE setCoalesceDataChanged NOTIFY coalesceDataChangedChanged)
+    Q_PROPERTY (QString sortRole READ sortRole WRITE setSortRole NOTIFY sortRoleChanged)
+    Q_PROPERTY (Qt::SortOrder sortOrder READ sortOrder WRITE setSortOrder NOTIFY sortOrderChanged)
 
 public:
-    explicit QQmlObjectListModelBase (QObject * parent = Q_NULLPTR) : QAbstractListModel (parent) { }
+    explicit QQmlObjectListModelBase (QObject * parent = Q_NULLPTR) : QAbstractListModel (parent), m_coalesceDataChanged (false), m_batchDepth (0), m_sortOrder (Qt::AscendingOrder), m_deleteBudget (4) { }
+
+	/** When enabled, item property changes are accumulated and notified once per event loop iteration,
+	 * as dataChanged on merged contiguous row ranges with the union of their roles. Disabled by default */
+    bool coalesceDataChanged (void) const { return m_coalesceDataChanged; }
+    void setCoalesceDataChanged (bool coalesce) {
+        if (m_coalesceDataChanged != coalesce) {
+            m_coalesceDataChanged = coalesce;
+            if (!coalesce) {
+                flushDataChanged ();
+            }
+            emit coalesceDataChangedChanged ();
+        }
+    }
+	/** When set, the model keeps its items sorted by this role : the items are sorted right away,
+	 * inserted items go to their sorted row whatever the requested position, and an item whose
+	 * sort role changes is moved to its new row. Empty by default, ie no automatic sorting */
+    const QString & sortRole (void) const { return m_sortRole; }
+    void setSortRole (const QString & role) {
+        if (m_sortRole != role) {
+            m_sortRole = role;
+            updateSortRole ();
+            emit sortRoleChanged ();
+        }
+    }
+	/** Order used when sortRole is set */
+    Qt::SortOrder sortOrder (void) const { return m_sortOrder; }
+    void setSortOrder (Qt::SortOrder order) {
+        if (m_sortOrder != order) {
+            m_sortOrder = order;
+            updateSortRole ();
+            emit sortOrderChanged ();
+        }
+    }
+	/** Time, in milliseconds, spent deleting removed items in each event loop iteration.
+	 * Owned items are deleted in chunks so that clearing a large model doesn't freeze the UI. 4 by default */
+    int deleteBudget (void) const { return m_deleteBudget; }
+    void setDeleteBudget (int msecs) { m_deleteBudget = qMax (msecs, 1); }
 
 public slots: // virtual methods API for QML
 	/** Returns the number of items in the list.
@@ -72,7 +112,8 @@ public slots: // virtual methods API for QML
 	virtual int indexOf (QObject * item) const = 0;
 	/** Get the role id of name, -1 if role not found */
 	virtual int roleForName (const QByteArray & name) const = 0;
-	/** Removes all items from the list. It won't delete any object */
+	/** Removes all items from the list, with a single model reset.
+	 * Items owned by the model are deleted over the next event loop iterations */
 	virtual void clear (void) = 0;
 	/** Inserts value at the end of the list.
 	 * This is the same as list.insert(size(), value).
@@ -106,18 +147,57 @@ public slots: // virtual methods API for QML
 	/** Removes the item at index position i.
 	 *i must be a valid index position in the list (i.e., 0 <= i < size()). */
 	virtual void remove (int idx) = 0;
+	/** Removes count items starting at index position first, with a single remove notification */
+	virtual void removeRange (int first, int count) = 0;
 	virtual QObject * get (int idx) const = 0;
 	virtual QObject * get (const QString & uid) const = 0;
 	virtual QObject * getFirst (void) const = 0;
 	virtual QObject * getLast (void) const = 0;
     virtual QVariantList toVarArray (void) const = 0;
+	/** Sort the items by the value of role, items with equal values keep their order.
+	 * Delegates are kept : views get a single layoutChanged and persistent indexes follow their item */
+	virtual void sortByRole (const QString & role, Qt::SortOrder order = Qt::AscendingOrder) = 0;
+	/** Sort the items by several roles, each role breaking the ties of the previous one */
+	virtual void sortByRoles (const QStringList & roles, Qt::SortOrder order = Qt::AscendingOrder) = 0;
+	/** Emit the pending coalesced dataChanged right away instead of waiting for the event loop */
+    virtual void flushDataChanged (void) = 0;
+	/** Start recording mutations. Row signals, countChanged and item signals are held
+	 * until the matching endBatch(), that emits the minimal set of them for the net change.
+	 * Batches can be nested, only the outermost endBatch() commits.
+	 * \sa QQmlModelBatch */
+    void beginBatch (void) {
+        if (m_batchDepth++ == 0) {
+            startBatch ();
+        }
+    }
+	/** Commit the mutations recorded since the matching beginBatch() */
+    void endBatch (void) {
+        if (m_batchDepth > 0 && --m_batchDepth == 0) {
+            commitBatch ();
+        }
+    }
+	/** Returns true between beginBatch() and the matching endBatch() */
+    bool isBatching (void) const { return m_batchDepth > 0; }
 
 protected slots: // internal callback
-    virtual void onItemPropertyChanged (void) = 0;
+    virtual void deletePendingItems (void) = 0;
+
+protected: // batch hooks
+    virtual void startBatch (void) = 0;
+    virtual void commitBatch (void) = 0;
+
+protected: // sort hook
+    virtual void updateSortRole (void) = 0;
 
 signals: // notifier
 	/** Emitted when count changed (ie removed or inserted item) */
     void countChanged (void);
+	/** Emitted when coalesceDataChanged changed */
+    void coalesceDataChangedChanged (void);
+	/** Emitted when sortRole changed */
+    void sortRoleChanged (void);
+	/** Emitted when sortOrder changed */
+    void sortOrderChanged (void);
 signals:
 	/** Emitted when an item is about to be inserted */
 	void itemAboutToBeInserted(QObject* item, int row);
@@ -131,456 +211,381 @@ signals:
 	void itemAboutToBeRemoved(QObject* item, int row);
 	/** Emitted when an item is about to be removed */
 	void itemRemoved(QObject* item, int row);
+
+private:
+    bool          m_coalesceDataChanged;
+    int           m_batchDepth;
+    QString       m_sortRole;
+    Qt::SortOrder m_sortOrder;
+    int           m_deleteBudget;
 };
 
-template<class ItemType> class QQmlObjectListModel : public QQmlObjectListModelBase
+template<class ItemType> class QQmlObjectListModel;
+template<class ItemType> class QQmlObjectListFilterModel;
+
+/**
+ * Items built on a worker thread, then handed over to a QQmlObjectListModel in one call.
+ *
+ * Created by QQmlObjectListModel::createBatch() on the thread of the model, the batch
+ * carries the role table of the model, so that the worker thread can do most of the
+ * work referencing an item costs : append() precomputes the uid key of the item and
+ * connects its notify signals to the model. Once filled, moveToModelThread() is called
+ * on the worker thread, and the batch is given to insertBatch() or appendBatch() on the
+ * thread of the model, which splice the items in with a single insert notification.
+ *
+ * \code
+ * QQmlObjectListBatch<Contact> * batch = model->createBatch ();
+ * QtConcurrent::run ([=] () {
+ *     for (const QJsonValue & json : contacts)
+ *         batch->append (new Contact (json.toObject ()));
+ *     batch->moveToModelThread ();
+ *     QMetaObject::invokeMethod (receiver, "onContactsReady", Q_ARG (void *, batch));
+ * });
+ * \endcode
+ */
+template<class ItemType> class QQmlObjectListBatch
 {
 public:
-    explicit QQmlObjectListModel (QObject *          parent      = Q_NULLPTR,
-								  const QList<QByteArray> & exposedRoles = QList<QByteArray>(),
-                                  const QByteArray & displayRole = QByteArray (),
-                                  const QByteArray & uidRole     = QByteArray ())
-        : QQmlObjectListModelBase (parent)
-        , m_count (0)
-        , m_uidRoleName (uidRole)
-        , m_dispRoleName (displayRole)
-        , m_metaObj (ItemType::staticMetaObject)
-    {
-		// Keep a track of black list rolename that are not compatible with Qml, they should never be used
-        static QSet<QByteArray> roleNamesBlacklist;
-        if (roleNamesBlacklist.isEmpty ()) {
-            roleNamesBlacklist << QByteArrayLiteral ("id")
-                               << QByteArrayLiteral ("index")
-                               << QByteArrayLiteral ("class")
-                               << QByteArrayLiteral ("model")
-                               << QByteArrayLiteral ("modelData");
-        }
-
-		// Set handler that handle every property changed
-        static const char * HANDLER = "onItemPropertyChanged()";
-        m_handler = metaObject ()->method (metaObject ()->indexOfMethod (HANDLER));
-
-		// Force a display role the the role map
-        if (!displayRole.isEmpty ()) {
-            m_roles.insert (Qt::DisplayRole, QByteArrayLiteral ("display"));
-        }
-		// Return a pointer to the qtObject as the base Role. This point is essential
-        m_roles.insert (baseRole (), QByteArrayLiteral ("qtObject"));
-
-		// Number of attribute declare with the Q_PROPERTY flags
-        const int len = m_metaObj.propertyCount ();
-		// For every property in the ItemType
-        for (int propertyIdx = 0, role = (baseRole () +1); propertyIdx < len; propertyIdx++, role++) {
-            QMetaProperty metaProp = m_metaObj.property (propertyIdx);
-            const QByteArray propName = QByteArray (metaProp.name ());
-			// Only expose the property as a role if:
-			// - It isn't blacklisted (id, index, class, model, modelData)
-			// - When exposedRoles is empty we expose every property
-			// - When exposedRoles isn't empty we only expose the property asked by the user
-            if (!roleNamesBlacklist.contains (propName) &&
-				(exposedRoles.size() == 0 || exposedRoles.contains(propName)))
-			{
-                m_roles.insert (role, propName);
-				// If there is a notify signal associated with the Q_PROPERTY we keep a track of it for fast lookup
-                if (metaProp.hasNotifySignal ())
-				{
-                    m_signalIdxToRole.insert (metaProp.notifySignalIndex (), role);
-                }
-            }
-            else if(roleNamesBlacklist.contains(propName))
-			{
-                static const QByteArray CLASS_NAME = (QByteArrayLiteral ("QQmlObjectListModel<") % m_metaObj.className () % '>');
-                qWarning () << "Can't have" << propName << "as a role name in" << qPrintable (CLASS_NAME) << ", because it's a blacklisted keywork in QML!. "
-            	"Please don't use any of the following words when declaring your Q_PROPERTY: (id, index, class, model, modelData)";
-            }
-        }
+    /** Items still in the batch are deleted, from the thread deleting the batch */
+    ~QQmlObjectListBatch (void) {
+        qDeleteAll (m_items);
     }
-    bool setData (const QModelIndex & index, const QVariant & value, int role) Q_DECL_FINAL {
-        bool ret = false;
-        ItemType * item = at (index.row ());
-        const QByteArray rolename = (role != Qt::DisplayRole ? m_roles.value (role, emptyBA ()) : m_dispRoleName);
-        if (item != Q_NULLPTR && role != baseRole () && !rolename.isEmpty ()) {
-            ret = item->setProperty (rolename, value);
-        }
-        return ret;
+    int count (void) const {
+        return m_items.count ();
     }
-    QVariant data (const QModelIndex & index, int role) const Q_DECL_FINAL {
-        QVariant ret;
-        ItemType * item = at (index.row ());
-        const QByteArray rolename = (role != Qt::DisplayRole ? m_roles.value (role, emptyBA ()) : m_dispRoleName);
-        if (item != Q_NULLPTR && !rolename.isEmpty ()) {
-            ret.setValue (role != baseRole () ? item->property (rolename) : QVariant::fromValue (static_cast<QObject *> (item)));
+    void reserve (int size) {
+        m_items.reserve (size);
+        if (m_roleTable->uidProperty ().isValid ()) {
+            m_uids.reserve (size);
         }
-        return ret;
-    }
-    QHash<int, QByteArray> roleNames (void) const Q_DECL_FINAL {
-        return m_roles;
     }
-    typedef typename QList<ItemType *>::const_iterator const_iterator;
-    const_iterator begin (void) const {
-        return m_items.begin ();
-    }
-    const_iterator end (void) const {
-        return m_items.end ();
+    const QList<ItemType *> & items (void) const {
+        return m_items;
     }
-    const_iterator constBegin (void) const {
-        return m_items.constBegin ();
+    /** Append item, which must have no parent. Set its properties first : its uid is read here */
+    void append (ItemType * item) {
+        if (item == Q_NULLPTR) {
+            return;
+        }
+        m_items.append (item);
+        if (m_roleTable->uidProperty ().isValid ()) {
+            m_uids.append (m_roleTable->uidProperty ().read (item).toString ());
+        }
+        const QVector<QMetaMethod> & notifyMethods = m_roleTable->notifyMethods ();
+        for (int idx = 0; idx < notifyMethods.count (); ++idx) {
+            QMetaObject::connect (item, notifyMethods.at (idx).methodIndex (), m_model, m_notifySlot + idx);
+        }
     }
-    const_iterator constEnd (void) const {
-        return m_items.constEnd ();
+    /** Move the items to the thread of the model. Call it from the thread that created them, as the last step */
+    void moveToModelThread (void) {
+        QThread * thread = m_model->thread ();
+        for (typename QList<ItemType *>::const_iterator it = m_items.constBegin (); it != m_items.constEnd (); ++it) {
+            (* it)->moveToThread (thread);
+        }
     }
 
+private:
+    friend class QQmlObjectListModel<ItemType>;
+
+    QQmlObjectListBatch (QObject * model, const QSharedPointer<const QQmlObjectRoleTable> & roleTable, int notifySlot)
+        : m_model (model)
+        , m_roleTable (roleTable)
+        , m_notifySlot (notifySlot)
+    { }
+    Q_DISABLE_COPY (QQmlObjectListBatch)
+
+    QObject *                                 m_model;
+    QSharedPointer<const QQmlObjectRoleTable> m_roleTable;
+    int                                       m_notifySlot;
+    QList<ItemType *>                         m_items;
+    QStringList                               m_uids;
+};
+
+template<class ItemType> class QQmlObjectListModel : public QQmlPointerListModel<ItemType *, QQmlObjectListModelBase>
+{
+    friend class QQmlObjectListFilterModel<ItemType>; // reads visibleItems ()
+
+    typedef QQmlPointerListModel<ItemType *, QQmlObjectListModelBase> Core;
+    using Core::m_items;
+    using Core::m_roleTable;
+
+public:
+    explicit QQmlObjectListModel (QObject *          parent      = Q_NULLPTR,
+								  const QList<QByteArray> & exposedRoles = QList<QByteArray>(),
+                                  const QByteArray & displayRole = QByteArray (),
+                                  const QByteArray & uidRole     = QByteArray ())
+        : Core (parent, exposedRoles, displayRole, uidRole, "QQmlObjectListModel")
+        , m_poolCapacity (0)
+        , m_poolHits (0)
+        , m_poolMisses (0)
+    { }
+
 public: // C++ API
-    ItemType * at (int idx) const {
-        ItemType * ret = Q_NULLPTR;
-        if (idx >= 0 && idx < m_items.size ()) {
-            ret = m_items.value (idx);
+	/** Empty batch of items to fill on a worker thread, then hand over with insertBatch () or appendBatch () */
+	QQmlObjectListBatch<ItemType> * createBatch (void) {
+        return new QQmlObjectListBatch<ItemType> (this, m_roleTable, Core::notifySlot ());
+    }
+	bool appendBatch (QQmlObjectListBatch<ItemType> * batch) {
+        return insertBatch (m_items.count (), batch);
+    }
+	/** Splice the items of batch in at idx with a single insert notification, then delete batch.
+	 * The uid keys and the connections made by the batch are reused, only the ownership is left to do.
+	 * A batch created by another model, or holding items that weren't moved to the thread of the model,
+	 * is rejected : nothing is inserted and batch is left intact, still owned by the caller.
+	 * \return Whether the batch was inserted */
+	bool insertBatch (int idx, QQmlObjectListBatch<ItemType> * batch) {
+        if (batch == Q_NULLPTR) {
+            return false;
         }
-        return ret;
-    }
-    ItemType * getByUid (const QString & uid) const {
-        return (!m_indexByUid.isEmpty () ? m_indexByUid.value (uid, Q_NULLPTR) : Q_NULLPTR);
-    }
-    int roleForName (const QByteArray & name) const Q_DECL_FINAL {
-        return m_roles.key (name, -1);
-    }
-	int count (void) const Q_DECL_FINAL {
-        return m_count;
-    }
-	int size (void) const Q_DECL_FINAL {
-        return m_count;
-    }
-	bool isEmpty (void) const Q_DECL_FINAL {
-        return m_items.isEmpty ();
-    }
-	bool contains (ItemType * item) const {
-        return m_items.contains (item);
-    }
-	int indexOf (ItemType * item) const {
-        return m_items.indexOf (item);
-    }
-	void clear (void) Q_DECL_FINAL {
-        if (!m_items.isEmpty ()) {
-			QList<ItemType*> tempList;
-			for (int i = 0; i < m_items.count(); ++i)
-				itemAboutToBeRemoved(m_items.at(i), i);
-            beginRemoveRows (noParent (), 0, m_items.count () -1);
-            FOREACH_PTR_IN_QLIST (ItemType, item, m_items) {
-                dereferenceItem (item);
-				tempList.append(item);
+        if (batch->m_model != this) {
+            qWarning () << "QQmlObjectListModel::insertBatch : the batch was created by another model";
+            return false;
+        }
+        for (typename QList<ItemType *>::const_iterator it = batch->m_items.constBegin (); it != batch->m_items.constEnd (); ++it) {
+            if ((* it)->thread () != this->thread ()) {
+                qWarning () << "QQmlObjectListModel::insertBatch : items must be moved with moveToModelThread () before the handover";
+                return false;
             }
-            m_items.clear ();
-            updateCounter ();
-            endRemoveRows ();
-			for (int i = 0; i < tempList.count(); ++i)
-				itemRemoved(tempList.at(i), i);
         }
-    }
-	void append (ItemType * item) {
-        if (item != Q_NULLPTR) {
-            const int pos = m_items.count ();
-			itemAboutToBeInserted(item, pos);
-            beginInsertRows (noParent (), pos, pos);
-            m_items.append (item);
-            referenceItem (item);
-            updateCounter ();
-            endInsertRows ();
-			itemInserted(item, pos);
+        QList<ItemType *> itemList;
+        itemList.swap (batch->m_items);
+        this->insertItems (idx, std::move (itemList), true, (!batch->m_uids.isEmpty () ? &batch->m_uids : Q_NULLPTR), true);
+        delete batch;
+        return true;
+    }
+	/** Keep up to capacity removed items owned by the model, instead of deleting them, and hand them
+	 * back through acquire (). reset is called on every recycled item, once it's disconnected from
+	 * the model, to bring it back to a default state. A capacity of 0 disables the pool.
+	 * A recycled item may still be read by a delegate being removed, use it with views not animating removals */
+	void setItemPool (int capacity, std::function<void (ItemType *)> reset = std::function<void (ItemType *)> ()) {
+        m_poolCapacity = qMax (capacity, 0);
+        m_poolReset = reset;
+        while (m_pool.count () > m_poolCapacity) {
+            m_pool.takeLast ()->deleteLater ();
         }
     }
-	void prepend (ItemType * item) {
-        if (item != Q_NULLPTR) {
-			itemAboutToBeInserted(item, 0);
-            beginInsertRows (noParent (), 0, 0);
-            m_items.prepend (item);
-            referenceItem (item);
-            updateCounter ();
-            endInsertRows ();
-			itemInserted(item, 0);
+	/** A recycled item from the pool when there's one, a new ItemType otherwise. The item is owned by
+	 * the model until it's inserted, so an item acquired and never inserted is deleted with the model */
+	ItemType * acquire (void) {
+        if (!m_pool.isEmpty ()) {
+            ++m_poolHits;
+            return m_pool.takeLast ();
         }
+        ++m_poolMisses;
+        return new ItemType (this);
     }
-	void insert (int idx, ItemType * item) {
-        if (item != Q_NULLPTR) {
-			itemAboutToBeInserted(item, idx);
-            beginInsertRows (noParent (), idx, idx);
-            m_items.insert (idx, item);
-            referenceItem (item);
-            updateCounter ();
-            endInsertRows ();
-			itemInserted(item, idx);
+	/** Delete the items waiting in the pool */
+	void clearItemPool (void) {
+        for (typename QList<ItemType *>::const_iterator it = m_pool.constBegin (); it != m_pool.constEnd (); ++it) {
+            (* it)->deleteLater ();
         }
-    }
-	void append (const QList<ItemType *> & itemList) {
-        if (!itemList.isEmpty ()) {
-            const int pos = m_items.count ();
-			for(int i = 0; i < itemList.count(); ++i)
-				itemAboutToBeInserted(itemList.at(i), i + pos);
-
-            beginInsertRows (noParent (), pos, pos + itemList.count () -1);
-            m_items.reserve (m_items.count () + itemList.count ());
-            m_items.append (itemList);
-            FOREACH_PTR_IN_QLIST (ItemType, item, itemList) {
-                referenceItem (item);
+        m_pool.clear ();
+    }
+	int itemPoolSize (void) const {
+        return m_pool.count ();
+    }
+	/** Number of acquire () calls served from the pool */
+	int itemPoolHits (void) const {
+        return m_poolHits;
+    }
+	/** Number of acquire () calls that had to create an item */
+	int itemPoolMisses (void) const {
+        return m_poolMisses;
+    }
+	/** Ratio of acquire () calls served from the pool, 0 if acquire () was never called */
+	qreal itemPoolHitRate (void) const {
+        const int calls = (m_poolHits + m_poolMisses);
+        return (calls > 0 ? qreal (m_poolHits) / calls : 0);
+    }
+	/** Immutable view of the items, that other threads can read while the model changes.
+	 * Call it on the thread of the model. \sa QQmlModelSnapshot */
+    QQmlModelSnapshot<ItemType *> snapshot (void) const {
+        return QQmlModelSnapshot<ItemType *> (m_items);
+    }
+	/** Write the exposed writable roles of every item to device, in the binary format of QQmlModelArchive.
+	 * Enums are saved as integers, roles whose type can't be streamed are skipped */
+    bool save (QIODevice * device) const {
+        QDataStream stream (device);
+        QVector<QQmlModelArchive::Column> columns;
+        QVector<int> roles;
+        QList<int> keys = m_roleTable->roleNames ().keys ();
+        std::sort (keys.begin (), keys.end ());
+        for (QList<int>::const_iterator it = keys.constBegin (); it != keys.constEnd (); ++it) {
+            const QMetaProperty & prop = m_roleTable->property (* it);
+            if (* it == Core::baseRole () || * it == Qt::DisplayRole || !prop.isWritable ()) {
+                continue;
+            }
+            const int type = (prop.isEnumType () ? int (QMetaType::Int) : m_roleTable->type (* it));
+            if (QQmlModelArchive::isStreamable (type)) {
+                columns.append (QQmlModelArchive::Column (m_roleTable->roleNames ().value (* it), type));
+                roles.append (* it);
             }
-            updateCounter ();
-            endInsertRows ();
-			for (int i = 0; i < itemList.count(); ++i)
-				itemInserted(itemList.at(i), i + pos);
         }
-    }
-	void prepend (const QList<ItemType *> & itemList) {
-        if (!itemList.isEmpty ()) {
-			for (int i = 0; i < itemList.count(); ++i)
-				itemAboutToBeInserted(itemList.at(i), i);
-            beginInsertRows (noParent (), 0, itemList.count () -1);
-            m_items.reserve (m_items.count () + itemList.count ());
-            int offset = 0;
-            FOREACH_PTR_IN_QLIST (ItemType, item, itemList) {
-                m_items.insert (offset, item);
-                referenceItem (item);
-                offset++;
+        if (!QQmlModelArchive::writeHeader (stream, columns, m_items.count ())) {
+            return false;
+        }
+        for (typename QList<ItemType *>::const_iterator it = m_items.constBegin (); it != m_items.constEnd (); ++it) {
+            for (int col = 0; col < columns.count (); ++col) {
+                QQmlModelArchive::writeValue (stream, columns.at (col).type, m_roleTable->read (* it, roles.at (col)));
             }
-            updateCounter ();
-            endInsertRows ();
-			for (int i = 0; i < itemList.count(); ++i)
-				itemInserted(itemList.at(i), i);
         }
-    }
-	void insert (int idx, const QList<ItemType *> & itemList) {
-        if (!itemList.isEmpty ()) {
-			for (int i = 0; i < itemList.count(); ++i)
-				itemAboutToBeInserted(itemList.at(i), i + idx);
-            beginInsertRows (noParent (), idx, idx + itemList.count () -1);
-            m_items.reserve (m_items.count () + itemList.count ());
-            int offset = 0;
-            FOREACH_PTR_IN_QLIST (ItemType, item, itemList) {
-                m_items.insert (idx + offset, item);
-                referenceItem (item);
-                offset++;
+        return (stream.status () == QDataStream::Ok);
+    }
+	/** Append one item per object of the JSON array read from device, keys being matched to roles by name.
+	 * The array is parsed one object at a time, each key is looked up in the role table once per call,
+	 * and the items, created with acquire (), are appended by chunks of chunkSize with one notification each.
+	 * \return Number of items appended, -1 if the input isn't an array of objects (the chunks before the error are kept) */
+    int appendFromJson (QIODevice * device, int chunkSize = 1000) {
+        QQmlModelJsonReader reader (device);
+        return appendFromJson (reader, chunkSize);
+    }
+    int appendFromJson (const QByteArray & json, int chunkSize = 1000) {
+        QQmlModelJsonReader reader (json);
+        return appendFromJson (reader, chunkSize);
+    }
+	/** Write the exposed roles of every item to device, as a JSON array of objects written one item at a time */
+    bool writeJson (QIODevice * device) const {
+        QVector<QString> keys;
+        QVector<int> roles;
+        QList<int> sorted = m_roleTable->roleNames ().keys ();
+        std::sort (sorted.begin (), sorted.end ());
+        for (QList<int>::const_iterator it = sorted.constBegin (); it != sorted.constEnd (); ++it) {
+            if (* it != Core::baseRole () && * it != Qt::DisplayRole) {
+                keys.append (QString::fromLatin1 (m_roleTable->roleNames ().value (* it)));
+                roles.append (* it);
             }
-            updateCounter ();
-            endInsertRows ();
-			for (int i = 0; i < itemList.count(); ++i)
-				itemInserted(itemList.at(i), i + idx);
         }
-    }
-	void move (int idx, int pos) Q_DECL_FINAL {
-        if (idx != pos && idx >=0 && pos>=0 && idx < m_items.size() && pos < m_items.size()) {
-			itemAboutToBeMoved(m_items.at(idx), idx, pos);
-            beginMoveRows (noParent (), idx, idx, noParent (), (idx < pos ? pos +1 : pos));
-            m_items.move (idx, pos);
-            endMoveRows ();
-			itemMoved(m_items.at(idx), idx, pos);
+        bool ret = (device->write ("[") == 1);
+        for (int row = 0; row < m_items.count () && ret; ++row) {
+            QJsonObject object;
+            for (int col = 0; col < roles.count (); ++col) {
+                object.insert (keys.at (col), QJsonValue::fromVariant (m_roleTable->read (m_items.at (row), roles.at (col))));
+            }
+            const QByteArray json = QJsonDocument (object).toJson (QJsonDocument::Compact);
+            ret = ((row == 0 || device->write (",") == 1) && device->write (json) == json.size ());
         }
-    }
-	void remove (ItemType * item) {
-        if (item != Q_NULLPTR) {
-            const int idx = m_items.indexOf (item);
-            remove (idx);
+        return (ret && device->write ("]") == 1);
+    }
+	/** Replace the items by the ones saved in device by save (), with a single notification.
+	 * Items are created with acquire (), saved roles missing from ItemType are ignored.
+	 * \return false, leaving the model untouched, if device doesn't hold a valid archive */
+    bool load (QIODevice * device) {
+        QDataStream stream (device);
+        QVector<QQmlModelArchive::Column> columns;
+        qint32 rows = 0;
+        if (!QQmlModelArchive::readHeader (stream, columns, rows)) {
+            return false;
         }
-    }
-	void remove (int idx) Q_DECL_FINAL {
-        if (idx >= 0 && idx < m_items.size ()) {
-			itemAboutToBeRemoved(m_items.at(idx), idx);
-            beginRemoveRows (noParent (), idx, idx);
-            ItemType * item = m_items.takeAt (idx);
-            dereferenceItem (item);
-            updateCounter ();
-            endRemoveRows ();
-			itemRemoved(item, idx);
+        QVector<int> roles;
+        roles.reserve (columns.count ());
+        for (QVector<QQmlModelArchive::Column>::const_iterator it = columns.constBegin (); it != columns.constEnd (); ++it) {
+            roles.append (m_roleTable->roleForName (it->name));
         }
-    }
-    ItemType * first (void) const {
-        return m_items.first ();
-    }
-    ItemType * last (void) const {
-        return m_items.last ();
-    }
-    const QList<ItemType *> & toList (void) const {
-        return m_items;
-    }
-
-public: // QML slots implementation
-    void append (QObject * item) Q_DECL_FINAL {
-        append (qobject_cast<ItemType *> (item));
-    }
-    void prepend (QObject * item) Q_DECL_FINAL {
-        prepend (qobject_cast<ItemType *> (item));
-    }
-    void insert (int idx, QObject * item) Q_DECL_FINAL {
-        insert (idx, qobject_cast<ItemType *> (item));
-    }
-    void remove (QObject * item) Q_DECL_FINAL {
-        remove (qobject_cast<ItemType *> (item));
-    }
-    bool contains (QObject * item) const Q_DECL_FINAL {
-        return contains (qobject_cast<ItemType *> (item));
-    }
-    int indexOf (QObject * item) const Q_DECL_FINAL {
-        return indexOf (qobject_cast<ItemType *> (item));
-    }
-    int indexOf (const QString & uid) const {
-        return indexOf (get (uid));
-    }
-    QObject * get (int idx) const Q_DECL_FINAL {
-        return static_cast<QObject *> (at (idx));
-    }
-    QObject * get (const QString & uid) const Q_DECL_FINAL {
-        return static_cast<QObject *> (getByUid (uid));
-    }
-    QObject * getFirst (void) const Q_DECL_FINAL {
-        return static_cast<QObject *> (first ());
-    }
-    QObject * getLast (void) const Q_DECL_FINAL {
-        return static_cast<QObject *> (last ());
-    }
-    QVariantList toVarArray (void) const Q_DECL_FINAL {
-        return qListToVariant<ItemType *> (m_items);
+        QList<ItemType *> itemList;
+        itemList.reserve (QQmlModelArchive::reserveHint (stream, rows, columns.count ()));
+        for (int row = 0; row < rows && stream.status () == QDataStream::Ok; ++row) {
+            if (!QQmlModelArchive::hasRowLeft (stream, columns.count ())) {
+                stream.setStatus (QDataStream::ReadPastEnd);
+                break;
+            }
+            ItemType * item = acquire ();
+            for (int col = 0; col < columns.count (); ++col) {
+                const QVariant value = QQmlModelArchive::readValue (stream, columns.at (col).type);
+                if (roles.at (col) > Core::baseRole ()) {
+                    m_roleTable->write (item, roles.at (col), value);
+                }
+            }
+            itemList.append (item);
+        }
+        if (stream.status () != QDataStream::Ok) {
+            qDeleteAll (itemList);
+            return false;
+        }
+        this->setItems (itemList);
+        return true;
     }
 
 protected: // internal stuff
-    static const QString & emptyStr (void) {
-        static const QString ret = QStringLiteral ("");
-        return ret;
-    }
-    static const QByteArray & emptyBA (void) {
-        static const QByteArray ret = QByteArrayLiteral ("");
-        return ret;
-    }
-    static const QModelIndex & noParent (void) {
-        static const QModelIndex ret = QModelIndex ();
-        return ret;
-    }
-    static const int & baseRole (void) {
-        static const int ret = Qt::UserRole;
-        return ret;
-    }
-    int rowCount (const QModelIndex & parent = QModelIndex ()) const Q_DECL_FINAL {
-        return (!parent.isValid () ? m_items.count () : 0);
-    }
-    void referenceItem (ItemType * item) {
-        if (item != Q_NULLPTR) {
-            if (!item->parent ()) {
-                item->setParent (this);
-            }
-            for (QHash<int, int>::const_iterator it = m_signalIdxToRole.constBegin (); it != m_signalIdxToRole.constEnd (); ++it) {
-				connect(item, item->metaObject()->method(it.key()), this, m_handler, Qt::UniqueConnection);
-            }
-            if (!m_uidRoleName.isEmpty ()) {
-                const QString key = m_indexByUid.key (item, emptyStr ());
-                if (!key.isEmpty ()) {
-                    m_indexByUid.remove (key);
+    int appendFromJson (QQmlModelJsonReader & reader, int chunkSize) {
+        QHash<QString, int> roleByKey; // once per schema, not once per field
+        QList<ItemType *> chunk;
+        int ret = 0;
+        QJsonObject object;
+        while (reader.readNext (object)) {
+            ItemType * item = acquire ();
+            for (QJsonObject::const_iterator it = object.constBegin (); it != object.constEnd (); ++it) {
+                typename QHash<QString, int>::const_iterator role = roleByKey.constFind (it.key ());
+                if (role == roleByKey.constEnd ()) {
+                    role = roleByKey.insert (it.key (), m_roleTable->roleForName (it.key ().toLatin1 ()));
                 }
-                const QString value = item->property (m_uidRoleName).toString ();
-                if (!value.isEmpty ()) {
-                    m_indexByUid.insert (value, item);
+                if (role.value () > Core::baseRole ()) {
+                    m_roleTable->write (item, role.value (), it.value ().toVariant ());
                 }
             }
+            chunk.append (item);
+            if (chunk.count () >= chunkSize) {
+                ret += chunk.count ();
+                this->append (std::move (chunk));
+                chunk = QList<ItemType *> ();
+            }
         }
-    }
-    void dereferenceItem (ItemType * item) {
-        if (item != Q_NULLPTR) {
-            disconnect (this, Q_NULLPTR, item, Q_NULLPTR);
-            disconnect (item, Q_NULLPTR, this, Q_NULLPTR);
-            if (!m_uidRoleName.isEmpty ()) {
-                const QString key = m_indexByUid.key (item, emptyStr ());
-                if (!key.isEmpty ()) {
-                    m_indexByUid.remove (key);
-                }
+        ret += chunk.count ();
+        this->append (std::move (chunk));
+        return (reader.hasError () ? -1 : ret);
+    }
+    /** Dispose of an owned item out of the model : back to the pool when it has room, deleted otherwise.
+     * An item to delete is left connected, its deletion disconnects it */
+    void releaseItem (ItemType * const & item, bool connected) Q_DECL_FINAL {
+        if (m_pool.count () < m_poolCapacity) {
+            if (connected) {
+                QObject::disconnect (item, Q_NULLPTR, this, Q_NULLPTR);
             }
-            if (item->parent () == this) { // FIXME : maybe that's not the best way to test ownership ?
-                item->deleteLater ();
+            if (m_poolReset) {
+                m_poolReset (item);
             }
+            m_pool.append (item);
+        }
+        else {
+            scheduleDelete (item);
         }
     }
-    void onItemPropertyChanged (void) Q_DECL_FINAL {
-        ItemType * item = qobject_cast<ItemType *> (sender ());
-        const int row = m_items.indexOf (item);
-        const int sig = senderSignalIndex ();
-        const int role = m_signalIdxToRole.value (sig, -1);
-        if (row >= 0 && role >= 0) {
-            const QModelIndex index = QAbstractListModel::index (row, 0, noParent ());
-            QVector<int> rolesList;
-            rolesList.append (role);
-            if (m_roles.value (role) == m_dispRoleName) {
-                rolesList.append (Qt::DisplayRole);
-            }
-            emit dataChanged (index, index, rolesList);
+    /** Queue item for deletion by deletePendingItems (), in the next event loop iterations.
+     * The queue holds guarded pointers : the caller may still delete a removed item, or take it back with setParent.
+     * An item removed twice is queued twice, its second entry is null once the first one deleted it */
+    void scheduleDelete (ItemType * item) {
+        if (m_pendingDeletes.isEmpty ()) {
+            QMetaObject::invokeMethod (this, "deletePendingItems", Qt::QueuedConnection);
         }
-        if (!m_uidRoleName.isEmpty ()) {
-            const QByteArray roleName = m_roles.value (role, emptyBA ());
-            if (!roleName.isEmpty () && roleName == m_uidRoleName) {
-                const QString key = m_indexByUid.key (item, emptyStr ());
-                if (!key.isEmpty ()) {
-                    m_indexByUid.remove (key);
-                }
-                const QString value = item->property (m_uidRoleName).toString ();
-                if (!value.isEmpty ()) {
-                    m_indexByUid.insert (value, item);
-                }
+        m_pendingDeletes.append (QPointer<ItemType> (item));
+    }
+    /** Delete pending items until deleteBudget is spent, and come back in the next iteration for the rest.
+     * Items are deleted in removal order, which is also their order in the children of the model */
+    void deletePendingItems (void) Q_DECL_FINAL {
+        QElapsedTimer timer;
+        timer.start ();
+        int done = 0;
+        while (done < m_pendingDeletes.count ()) {
+            ItemType * item = m_pendingDeletes.at (done++).data ();
+            if (item != Q_NULLPTR && item->parent () == this && !this->contains (item)) { // not deleted, taken nor inserted back in the meantime
+                delete item;
+            }
+            if ((done % 64) == 0 && timer.elapsed () >= this->deleteBudget ()) {
+                break;
             }
         }
-    }
-    inline void updateCounter (void) {
-        if (m_count != m_items.count ()) {
-            m_count = m_items.count ();
-            emit countChanged ();
+        m_pendingDeletes.erase (m_pendingDeletes.begin (), m_pendingDeletes.begin () + done);
+        if (!m_pendingDeletes.isEmpty ()) {
+            QMetaObject::invokeMethod (this, "deletePendingItems", Qt::QueuedConnection);
         }
     }
 
-private:
-	void itemAboutToBeInserted(ItemType* item, int row) { onItemAboutToBeInserted(item, row); _onItemAboutToBeInserted(item, row); }
-	void itemInserted(ItemType* item, int row) { onItemInserted(item, row); _onItemInserted(item, row);	}
-	void itemAboutToBeMoved(ItemType* item, int src, int dest) { onItemAboutToBeMoved(item, src, dest); _onItemAboutToBeMoved(item, src, dest);	}
-	void itemMoved(ItemType* item, int src, int dest) { onItemMoved(item, src, dest); _onItemMoved(item, src, dest); }
-	void itemAboutToBeRemoved(ItemType* item, int row) { onItemAboutToBeRemoved(item, row); _onItemAboutToBeRemoved(item, row); }
-	void itemRemoved(ItemType* item, int row) { onItemRemoved(item, row); _onItemRemoved(item, row); }
-
-protected:
-	virtual void onItemAboutToBeInserted(ItemType* item, int row) { }
-	virtual void onItemInserted(ItemType* item, int row) { }
-	virtual void onItemAboutToBeMoved(ItemType* item, int src, int dest) { }
-	virtual void onItemMoved(ItemType* item, int src, int dest) { }
-	virtual void onItemAboutToBeRemoved(ItemType* item, int row) { }
-	virtual void onItemRemoved(ItemType* item, int row) { }
-
-private:
-	void _onItemAboutToBeInserted(ItemType* item, int row) { emit QQmlObjectListModelBase::itemAboutToBeInserted(item, row); }
-	void _onItemInserted(ItemType* item, int row) { emit QQmlObjectListModelBase::itemInserted(item, row); }
-	void _onItemAboutToBeMoved(ItemType* item, int src, int dest) { emit QQmlObjectListModelBase::itemAboutToBeMoved(item, src, dest); }
-	void _onItemMoved(ItemType* item, int src, int dest) { emit QQmlObjectListModelBase::itemMoved(item, src, dest); }
-	void _onItemAboutToBeRemoved(ItemType* item, int row) { emit QQmlObjectListModelBase::itemAboutToBeRemoved(item, row); }
-	void _onItemRemoved(ItemType* item, int row) { emit QQmlObjectListModelBase::itemRemoved(item, row); }
-
-	/** Move row to row-1 */
-	void moveUp(const int row) override final
-    {
-		if (row > 0 && row < count())
-			move(row, row - 1);
-    }
-
-	/** Move row to row+1 */
-	void moveDown(const int row) override final
-    {
-		if (count() && // There is a least one entry
-			row >= 0 && // We can be from the first
-			row < (count() - 1) // To the last one minus 1
-			)
-		{
-			return moveUp(row + 1);
-		}
-    }
-
 private: // data members
-    int                        m_count;
-    QByteArray                 m_uidRoleName;
-    QByteArray                 m_dispRoleName;
-    QMetaObject                m_metaObj;
-    QMetaMethod                m_handler;
-    QHash<int, QByteArray>     m_roles;
-    QHash<int, int>            m_signalIdxToRole;
-    QList<ItemType *>          m_items;
-    QHash<QString, ItemType *> m_indexByUid;
+    int                        m_poolCapacity;
+    QList<ItemType *>          m_pool;
+    std::function<void (ItemType *)> m_poolReset;
+    int                        m_poolHits;
+    int                        m_poolMisses;
+    QList<QPointer<ItemType> > m_pendingDeletes;
 };
 
 #define QQMLMODEL_OBJ_PROPERTY(type, name, Name) \
@@ -598,6 +603,22 @@ private: // data members
     public: type * Get##Name (void) const { return _##name; } \
     private:
 
+/**
+ * Same as QQMLMODEL_OBJ_PROPERTY, but the model is only created by the first Get##Name() call,
+ * so owners whose list is never read don't pay for it. Once created, the model stays for the
+ * lifetime of the owner, like the property is CONSTANT for QML.
+ */
+#define QQMLMODEL_LAZY_OBJ_PROPERTY(type, name, Name) \
+	QQMLMODEL_LAZY_OBJ_PROPERTY_SUB(QQMLMODEL_NAMESPACE_NAME::QQmlObjectListModel<type>, name, Name)
+
+#define QQMLMODEL_LAZY_OBJ_PROPERTY_SUB(type, name, Name) \
+    protected: Q_PROPERTY (QQMLMODEL_NAMESPACE_NAME::QQmlObjectListModelBase * name READ Get##Name CONSTANT) \
+    QQMLMODEL_LAZY_PROPERTY_IMPL(type, name, Name)
+
+#define QQMLMODEL_LAZY_OBJ_PROPERTY_SUB_NO_T(type, name, Name) \
+    protected: Q_PROPERTY (type * name READ Get##Name CONSTANT) \
+    QQMLMODEL_LAZY_PROPERTY_IMPL(type, name, Name)
+
 /**
  * \internal
  */
@@ -615,6 +636,7 @@ class _Test_QmlModelObj : public QObject
 {
 	Q_OBJECT
 	QQMLMODEL_OBJ_PROPERTY(_Test_TestObj, myObject, MyObject);
+	QQMLMODEL_LAZY_OBJ_PROPERTY(_Test_TestObj, myLazyObject, MyLazyObject);
 };
 
 QQMLMODEL_NAMESPACE_END
@@ -0,0 +1,216 @@
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QStringBuilder>
+
+#include "QQmlObjectRoleTable.h"
+
+QQMLMODEL_USING_NAMESPACE;
+
+/*!
+    \class QQmlObjectRoleTable
+
+    \ingroup QT_QML_MODELS
+
+    \brief Role to QMetaProperty dispatch table used by QQmlObjectListModel and QQmlSharedObjectListModel
+
+    \sa QQmlObjectListModel, QQmlSharedObjectListModel
+*/
+
+/*!
+    \details Walks every property of \a metaObj once and builds the role, type and notify signal tables.
+*/
+QQmlObjectRoleTable::QQmlObjectRoleTable (const QMetaObject & metaObj,
+                                          const QList<QByteArray> & exposedRoles,
+                                          const QByteArray & displayRole,
+                                          const QByteArray & uidRole,
+                                          const char * modelName)
+    : m_dispRole (-1)
+    , m_dispType (QMetaType::UnknownType)
+    , m_uidRole (-1)
+{
+    // Keep a track of black list rolename that are not compatible with Qml, they should never be used
+    static QSet<QByteArray> roleNamesBlacklist;
+    if (roleNamesBlacklist.isEmpty ()) {
+        roleNamesBlacklist << QByteArrayLiteral ("id")
+                           << QByteArrayLiteral ("index")
+                           << QByteArrayLiteral ("class")
+                           << QByteArrayLiteral ("model")
+                           << QByteArrayLiteral ("modelData");
+    }
+
+    // Force a display role the the role map
+    if (!displayRole.isEmpty ()) {
+        m_roles.insert (Qt::DisplayRole, QByteArrayLiteral ("display"));
+        const int dispIdx = metaObj.indexOfProperty (displayRole.constData ());
+        if (dispIdx >= 0) {
+            m_dispProp = metaObj.property (dispIdx);
+            m_dispType = m_dispProp.userType ();
+        }
+    }
+    // Return a pointer to the qtObject as the base Role. This point is essential
+    m_roles.insert (baseRole (), QByteArrayLiteral ("qtObject"));
+
+    // Number of attribute declare with the Q_PROPERTY flags
+    const int len = metaObj.propertyCount ();
+    // Slot 0 is the qtObject role, it isn't backed by any property
+    m_props.resize (len + 1);
+    m_types.fill (QMetaType::UnknownType, len + 1);
+    m_rolesBySignal.resize (metaObj.methodCount ());
+    // For every property in the ItemType
+    for (int propertyIdx = 0, role = (baseRole () +1); propertyIdx < len; propertyIdx++, role++) {
+        QMetaProperty metaProp = metaObj.property (propertyIdx);
+        const QByteArray propName = QByteArray (metaProp.name ());
+        // Only expose the property as a role if:
+        // - It isn't blacklisted (id, index, class, model, modelData)
+        // - When exposedRoles is empty we expose every property
+        // - When exposedRoles isn't empty we only expose the property asked by the user
+        if (!roleNamesBlacklist.contains (propName) &&
+            (exposedRoles.size () == 0 || exposedRoles.contains (propName)))
+        {
+            m_roles.insert (role, propName);
+            m_props [role - baseRole ()] = metaProp;
+            m_types [role - baseRole ()] = metaProp.userType ();
+            // If there is a notify signal associated with the Q_PROPERTY we keep a track of it for fast lookup
+            if (metaProp.hasNotifySignal ()) {
+                QVector<int> & signalRoles = m_rolesBySignal [metaProp.notifySignalIndex ()];
+                if (signalRoles.isEmpty ()) {
+                    m_notifyMethods.append (metaProp.notifySignal ());
+                    m_notifySignals.append (metaProp.notifySignalIndex ());
+                }
+                signalRoles.append (role);
+                if (propName == displayRole) {
+                    signalRoles.append (Qt::DisplayRole);
+                }
+            }
+            if (propName == displayRole) {
+                m_dispRole = role;
+            }
+            if (propName == uidRole) {
+                m_uidRole = role;
+                m_uidProp = metaProp;
+            }
+        }
+        else if (roleNamesBlacklist.contains (propName)) {
+            const QByteArray className = (QByteArray (modelName) % '<' % metaObj.className () % '>');
+            qWarning () << "Can't have" << propName << "as a role name in" << qPrintable (className) << ", because it's a blacklisted keywork in QML!. "
+            "Please don't use any of the following words when declaring your Q_PROPERTY: (id, index, class, model, modelData)";
+        }
+    }
+    // The uid property doesn't have to be exposed to be used as an index key
+    if (!uidRole.isEmpty () && !m_uidProp.isValid ()) {
+        const int uidIdx = metaObj.indexOfProperty (uidRole.constData ());
+        if (uidIdx >= 0) {
+            m_uidProp = metaObj.property (uidIdx);
+        }
+    }
+
+    for (QHash<int, QByteArray>::const_iterator it = m_roles.constBegin (); it != m_roles.constEnd (); ++it) {
+        m_roleByName.insert (it.value (), it.key ());
+    }
+}
+
+/*!
+    \internal
+    \details Identifies the tables built by QQmlObjectRoleTable::cached().
+*/
+struct QQmlObjectRoleTableKey
+{
+    const QMetaObject * metaObj;
+    QList<QByteArray>   exposedRoles;
+    QByteArray          displayRole;
+    QByteArray          uidRole;
+
+    bool operator== (const QQmlObjectRoleTableKey & other) const {
+        return (metaObj == other.metaObj &&
+                exposedRoles == other.exposedRoles &&
+                displayRole == other.displayRole &&
+                uidRole == other.uidRole);
+    }
+};
+
+/*!
+    \internal
+*/
+static uint qHash (const QQmlObjectRoleTableKey & key, uint seed = 0)
+{
+    uint ret = (::qHash (key.metaObj, seed) ^ ::qHash (key.displayRole, seed) ^ (::qHash (key.uidRole, seed) << 1));
+    for (QList<QByteArray>::const_iterator it = key.exposedRoles.constBegin (); it != key.exposedRoles.constEnd (); ++it) {
+        ret = ((ret << 1) ^ ::qHash (* it, seed));
+    }
+    return ret;
+}
+
+/*!
+    \details Returns the table for \a metaObj and these roles, shared by every model asking for the same combination.
+
+    The first request walks the meta object, the next ones are a hash lookup and a reference count increment.
+    Tables live until the end of the application.
+*/
+QSharedPointer<const QQmlObjectRoleTable> QQmlObjectRoleTable::cached (const QMetaObject & metaObj,
+                                                                       const QList<QByteArray> & exposedRoles,
+                                                                       const QByteArray & displayRole,
+                                                                       const QByteArray & uidRole,
+                                                                       const char * modelName)
+{
+    static QMutex mutex;
+    static QHash<QQmlObjectRoleTableKey, QSharedPointer<const QQmlObjectRoleTable> > tables;
+    QQmlObjectRoleTableKey key;
+    key.metaObj = &metaObj;
+    key.exposedRoles = exposedRoles;
+    key.displayRole = displayRole;
+    key.uidRole = uidRole;
+    QMutexLocker locker (&mutex);
+    QSharedPointer<const QQmlObjectRoleTable> & ret = tables [key];
+    if (ret.isNull ()) {
+        ret = QSharedPointer<const QQmlObjectRoleTable> (new QQmlObjectRoleTable (metaObj, exposedRoles, displayRole, uidRole, modelName));
+    }
+    return ret;
+}
+
+/*!
+    \details Writes \a value in \a role of \a item.
+
+    The value is converted once to the precomputed property type when it doesn't match already.
+
+    \return Whether the property was written
+*/
+bool QQmlObjectRoleTable::write (QObject * item, int role, const QVariant & value) const
+{
+    const QMetaProperty & prop = property (role);
+    if (item == Q_NULLPTR || !prop.isValid () || !prop.isWritable ()) {
+        return false;
+    }
+    return prop.write (item, converted (role, value));
+}
+
+/*!
+    \details Writes \a value in \a role of the Q_GADGET pointed by \a gadget, like write() does for a QObject.
+
+    \return Whether the property was written
+*/
+bool QQmlObjectRoleTable::writeOnGadget (void * gadget, int role, const QVariant & value) const
+{
+    const QMetaProperty & prop = property (role);
+    if (gadget == Q_NULLPTR || !prop.isValid () || !prop.isWritable ()) {
+        return false;
+    }
+    return prop.writeOnGadget (gadget, converted (role, value));
+}
+
+/*!
+    \internal
+    \details Returns \a value converted to the type of \a role, or \a value itself when it already matches or can't be converted.
+*/
+QVariant QQmlObjectRoleTable::converted (int role, const QVariant & value) const
+{
+    const int propType = type (role);
+    if (propType == QMetaType::QVariant || value.userType () == propType) {
+        return value;
+    }
+    QVariant ret (value);
+    // Enums and flags written from their key names are handled by QMetaProperty itself
+    return (ret.convert (propType) ? ret : value);
+}
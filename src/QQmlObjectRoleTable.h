@@ -0,0 +1,141 @@
+#ifndef QQMLOBJECTROLETABLE_H
+#define QQMLOBJECTROLETABLE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMetaObject>
+#include <QMetaProperty>
+#include <QObject>
+#include <QSharedPointer>
+#include <QVariant>
+#include <QVector>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * Flat role dispatch table shared by the object list models.
+ *
+ * Built once from the item meta object, it maps every role to its
+ * QMetaProperty and QMetaType id, and every notify signal index to the roles
+ * it notifies, so that data(), setData() and the property changed handler
+ * never have to look up a property by name.
+ *
+ * Properties sharing a notify signal share one connection per item : the
+ * signal is listed once in notifyMethods() and notifies all their roles.
+ *
+ * Roles are numbered Qt::UserRole + 1 + propertyIndex, Qt::UserRole being the
+ * 'qtObject' role and Qt::DisplayRole an alias of the display property.
+ *
+ * Tables are immutable once built, models get them through cached() so that
+ * every model of the same item type and roles shares a single table.
+ *
+ * The table also works on the meta object of a Q_GADGET, through
+ * readOnGadget() and writeOnGadget().
+ */
+class QQMLMODEL_API_ QQmlObjectRoleTable
+{
+public:
+    /** Build the table for metaObj.
+     * \param exposedRoles Properties to expose, every property when empty
+     * \param displayRole Name of the property aliased by Qt::DisplayRole, can be empty
+     * \param uidRole Name of the property used as unique identifier, can be empty
+     * \param modelName Name of the model used in warnings */
+    QQmlObjectRoleTable (const QMetaObject & metaObj,
+                         const QList<QByteArray> & exposedRoles,
+                         const QByteArray & displayRole,
+                         const QByteArray & uidRole,
+                         const char * modelName);
+
+    /** Table for metaObj and these roles, built on first request then shared by every caller.
+     * Thread safe. \sa QQmlObjectRoleTable () */
+    static QSharedPointer<const QQmlObjectRoleTable> cached (const QMetaObject & metaObj,
+                                                            const QList<QByteArray> & exposedRoles,
+                                                            const QByteArray & displayRole,
+                                                            const QByteArray & uidRole,
+                                                            const char * modelName);
+
+    /** Role returning the item itself */
+    static int baseRole (void) { return Qt::UserRole; }
+
+    const QHash<int, QByteArray> & roleNames (void) const { return m_roles; }
+    /** Get the role id of name, -1 if role not found */
+    int roleForName (const QByteArray & name) const { return m_roleByName.value (name, -1); }
+    /** Roles notified by signal index signalIdx, Qt::DisplayRole included when it aliases one of them.
+     * Empty if signalIdx doesn't notify any exposed role */
+    const QVector<int> & rolesForSignal (int signalIdx) const {
+        return (signalIdx >= 0 && signalIdx < m_rolesBySignal.size () ? m_rolesBySignal.at (signalIdx) : noRoles ());
+    }
+    /** Every distinct notify signal of the exposed roles, to connect once per item */
+    const QVector<QMetaMethod> & notifyMethods (void) const { return m_notifyMethods; }
+    /** Roles notified by the signal at idx in notifyMethods(), idx must be valid */
+    const QVector<int> & rolesForNotify (int idx) const { return m_rolesBySignal.at (m_notifySignals.at (idx)); }
+    /** Property backing role, invalid property if none. Qt::DisplayRole resolves to the display property */
+    const QMetaProperty & property (int role) const {
+        if (role == Qt::DisplayRole) {
+            return m_dispProp;
+        }
+        const int idx = (role - baseRole ());
+        return (idx > 0 && idx < m_props.size () ? m_props.at (idx) : invalidProperty ());
+    }
+    /** QMetaType id of role, QMetaType::UnknownType if none */
+    int type (int role) const {
+        if (role == Qt::DisplayRole) {
+            return m_dispType;
+        }
+        const int idx = (role - baseRole ());
+        return (idx > 0 && idx < m_types.size () ? m_types.at (idx) : int (QMetaType::UnknownType));
+    }
+    /** Exposed role aliased by Qt::DisplayRole, -1 if none */
+    int displayRole (void) const { return m_dispRole; }
+    /** Exposed role used as unique identifier, -1 if none */
+    int uidRole (void) const { return m_uidRole; }
+    /** Property used as unique identifier, invalid property if none */
+    const QMetaProperty & uidProperty (void) const { return m_uidProp; }
+
+    /** Read role of item, invalid QVariant if role isn't backed by a property */
+    QVariant read (const QObject * item, int role) const {
+        const QMetaProperty & prop = property (role);
+        return (prop.isValid () ? prop.read (item) : QVariant ());
+    }
+    /** Write value in role of item, converting it to the property type when needed */
+    bool write (QObject * item, int role, const QVariant & value) const;
+    /** Read role of the Q_GADGET pointed by gadget, invalid QVariant if role isn't backed by a property */
+    QVariant readOnGadget (const void * gadget, int role) const {
+        const QMetaProperty & prop = property (role);
+        return (prop.isValid () ? prop.readOnGadget (gadget) : QVariant ());
+    }
+    /** Write value in role of the Q_GADGET pointed by gadget, converting it to the property type when needed */
+    bool writeOnGadget (void * gadget, int role, const QVariant & value) const;
+
+private:
+    QVariant converted (int role, const QVariant & value) const;
+    static const QMetaProperty & invalidProperty (void) {
+        static const QMetaProperty ret;
+        return ret;
+    }
+    static const QVector<int> & noRoles (void) {
+        static const QVector<int> ret;
+        return ret;
+    }
+
+private:
+    int                        m_dispRole;
+    int                        m_dispType;
+    int                        m_uidRole;
+    QMetaProperty              m_dispProp;
+    QMetaProperty              m_uidProp;
+    QHash<int, QByteArray>     m_roles;
+    QHash<QByteArray, int>     m_roleByName;
+    QVector<QMetaProperty>     m_props;
+    QVector<int>               m_types;
+    QVector<QVector<int> >     m_rolesBySignal;
+    QVector<QMetaMethod>       m_notifyMethods;
+    QVector<int>               m_notifySignals;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLOBJECTROLETABLE_H
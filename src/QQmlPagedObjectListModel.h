@@ -0,0 +1,318 @@
+#ifndef QQMLPAGEDOBJECTLISTMODEL_H
+#define QQMLPAGEDOBJECTLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMetaMethod>
+#include <QObject>
+#include <QVariant>
+#include <QVector>
+
+#include "QQmlModelShared.h"
+#include "QQmlObjectRoleTable.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * Source of the items of a QQmlPagedObjectListModel.
+ *
+ * Pages are requested on the GUI thread when a view first reads one of their
+ * rows, and may be requested again after they were evicted.
+ */
+template<class ItemType> class QQmlModelPageProvider
+{
+public:
+    virtual ~QQmlModelPageProvider (void) { }
+    /** Total number of rows available */
+    virtual int count (void) const = 0;
+    /** Create the items of the rows [first, first + count). The model takes ownership of the
+     * items that have no parent. Returning less items leaves the missing rows empty */
+    virtual QList<ItemType *> loadPage (int first, int count) = 0;
+};
+
+class QQmlPagedObjectListModelBase : public QAbstractListModel { // abstract Qt base class
+    Q_OBJECT
+    Q_PROPERTY (int count READ count NOTIFY countChanged)
+    Q_PROPERTY (int length READ count NOTIFY countChanged)
+    Q_PROPERTY (int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
+    Q_PROPERTY (int maxLoadedItems READ maxLoadedItems WRITE setMaxLoadedItems NOTIFY maxLoadedItemsChanged)
+
+public:
+    explicit QQmlPagedObjectListModelBase (QObject * parent = Q_NULLPTR) : QAbstractListModel (parent), m_pageSize (100), m_maxLoadedItems (2000) { }
+
+	/** Number of rows loaded by each provider request and added by each fetchMore(). 100 by default */
+    int pageSize (void) const { return m_pageSize; }
+    void setPageSize (int pageSize) {
+        if (pageSize > 0 && m_pageSize != pageSize) {
+            m_pageSize = pageSize;
+            if (m_maxLoadedItems < pageSize) {
+                m_maxLoadedItems = pageSize;
+                emit maxLoadedItemsChanged ();
+            }
+            emit pageSizeChanged ();
+            reload ();
+        }
+    }
+	/** Memory budget, in items. When more items are loaded, the least recently read pages are
+	 * deleted and will be loaded again on their next read. 2000 by default.
+	 * Values <= 0 are ignored, smaller values are raised to one pageSize */
+    int maxLoadedItems (void) const { return m_maxLoadedItems; }
+    void setMaxLoadedItems (int maxLoadedItems) {
+        if (maxLoadedItems <= 0) {
+            return;
+        }
+        maxLoadedItems = qMax (maxLoadedItems, m_pageSize);
+        if (m_maxLoadedItems != maxLoadedItems) {
+            m_maxLoadedItems = maxLoadedItems;
+            evictPages (-1);
+            emit maxLoadedItemsChanged ();
+        }
+    }
+
+public slots: // virtual methods API for QML
+	/** Returns the number of rows fetched so far */
+	virtual int count (void) const = 0;
+	/** Returns the item at row, loading its page if needed.
+	 * The item may be deleted once its page is evicted, don't keep it around */
+	virtual QObject * get (int row) const = 0;
+	/** Drop every loaded page and fetch the rows again, ie when the provider content changed */
+	virtual void reload (void) = 0;
+
+protected: // paging hooks
+    virtual void evictPages (int keptPage) const = 0;
+
+protected slots: // internal callback
+    virtual void onItemPropertyChanged (void) = 0;
+
+signals: // notifier
+	/** Emitted when count changed (ie rows were fetched) */
+    void countChanged (void);
+	/** Emitted when pageSize changed */
+    void pageSizeChanged (void);
+	/** Emitted when maxLoadedItems changed */
+    void maxLoadedItemsChanged (void);
+
+private:
+    int m_pageSize;
+    int m_maxLoadedItems;
+};
+
+/**
+ * Virtualized list model for very large datasets.
+ *
+ * Items don't all exist at once : rows are fetched by pages through
+ * canFetchMore()/fetchMore(), and items are only created by the page
+ * provider when a view reads a row of their page. Pages are kept in a least
+ * recently used cache bounded by maxLoadedItems, cold pages are deleted.
+ *
+ * Roles are the same as QQmlObjectListModel<ItemType> : every exposed
+ * property, Qt::DisplayRole for the display property and 'qtObject' for the
+ * item itself, and property changes of loaded items are notified as
+ * dataChanged.
+ */
+template<class ItemType> class QQmlPagedObjectListModel : public QQmlPagedObjectListModelBase
+{
+public:
+    explicit QQmlPagedObjectListModel (QObject *                 parent       = Q_NULLPTR,
+                                       const QList<QByteArray> & exposedRoles = QList<QByteArray> (),
+                                       const QByteArray &        displayRole  = QByteArray ())
+        : QQmlPagedObjectListModelBase (parent)
+        , m_provider (Q_NULLPTR)
+        , m_count (0)
+        , m_roleTable (QQmlObjectRoleTable::cached (ItemType::staticMetaObject, exposedRoles, displayRole, QByteArray (), "QQmlPagedObjectListModel"))
+        , m_loadedItems (0)
+    {
+        // Set handler that handle every property changed
+        static const QMetaMethod HANDLER = QQmlPagedObjectListModelBase::staticMetaObject.method (QQmlPagedObjectListModelBase::staticMetaObject.indexOfMethod ("onItemPropertyChanged()"));
+        m_handler = HANDLER;
+    }
+    ~QQmlPagedObjectListModel (void) {
+        clearPages ();
+    }
+    bool setData (const QModelIndex & index, const QVariant & value, int role) Q_DECL_FINAL {
+        bool ret = false;
+        ItemType * item = at (index.row ());
+        if (item != Q_NULLPTR && role != QQmlObjectRoleTable::baseRole ()) {
+            ret = m_roleTable->write (item, role, value);
+        }
+        return ret;
+    }
+    QVariant data (const QModelIndex & index, int role) const Q_DECL_FINAL {
+        QVariant ret;
+        ItemType * item = at (index.row ());
+        if (item != Q_NULLPTR) {
+            ret = (role != QQmlObjectRoleTable::baseRole () ? m_roleTable->read (item, role) : QVariant::fromValue (static_cast<QObject *> (item)));
+        }
+        return ret;
+    }
+    QHash<int, QByteArray> roleNames (void) const Q_DECL_FINAL {
+        return m_roleTable->roleNames ();
+    }
+    int rowCount (const QModelIndex & parent = QModelIndex ()) const Q_DECL_FINAL {
+        Q_UNUSED (parent);
+        return m_count;
+    }
+    bool canFetchMore (const QModelIndex & parent) const Q_DECL_FINAL {
+        Q_UNUSED (parent);
+        return (m_provider != Q_NULLPTR && m_count < m_provider->count ());
+    }
+    void fetchMore (const QModelIndex & parent) Q_DECL_FINAL {
+        Q_UNUSED (parent);
+        if (canFetchMore (noParent ())) {
+            const int fetched = qMin (pageSize (), m_provider->count () - m_count);
+            beginInsertRows (noParent (), m_count, m_count + fetched -1);
+            m_count += fetched;
+            endInsertRows ();
+            emit countChanged ();
+        }
+    }
+
+public: // C++ API
+    QQmlModelPageProvider<ItemType> * pageProvider (void) const {
+        return m_provider;
+    }
+    /** Set the source of the items, the model doesn't take ownership of provider */
+    void setPageProvider (QQmlModelPageProvider<ItemType> * provider) {
+        if (m_provider != provider) {
+            m_provider = provider;
+            reload ();
+        }
+    }
+    /** Item at row, loading its page if needed. Q_NULLPTR if row isn't fetched */
+    ItemType * at (int row) const {
+        if (row < 0 || row >= m_count) {
+            return Q_NULLPTR;
+        }
+        const int page = (row / pageSize ());
+        const Page & loaded = loadPage (page);
+        return loaded.items.value (row - page * pageSize (), Q_NULLPTR);
+    }
+    /** Number of items currently alive */
+    int loadedItems (void) const {
+        return m_loadedItems;
+    }
+	int count (void) const Q_DECL_FINAL {
+        return m_count;
+    }
+	QObject * get (int row) const Q_DECL_FINAL {
+        return at (row);
+    }
+	void reload (void) Q_DECL_FINAL {
+        const int oldCount = m_count;
+        beginResetModel ();
+        clearPages ();
+        m_count = (m_provider != Q_NULLPTR ? qMin (pageSize (), m_provider->count ()) : 0);
+        endResetModel ();
+        if (m_count != oldCount) {
+            emit countChanged ();
+        }
+    }
+
+protected: // internal stuff
+    struct Page {
+        QList<ItemType *> items;
+    };
+
+    static const QModelIndex & noParent (void) {
+        static const QModelIndex ret = QModelIndex ();
+        return ret;
+    }
+    /** Page from the cache, asking the provider for it on a miss, and mark it as most recently used */
+    const Page & loadPage (int page) const {
+        typename QHash<int, Page>::iterator it = m_pages.find (page);
+        if (it != m_pages.end ()) {
+            if (m_recentPages.last () != page) {
+                m_recentPages.removeOne (page);
+                m_recentPages.append (page);
+            }
+            return it.value ();
+        }
+        Page loaded;
+        if (m_provider != Q_NULLPTR) {
+            const int first = (page * pageSize ());
+            loaded.items = m_provider->loadPage (first, qMin (pageSize (), m_count - first));
+        }
+        QQmlPagedObjectListModel * self = const_cast<QQmlPagedObjectListModel *> (this);
+        for (int idx = 0; idx < loaded.items.count (); ++idx) {
+            if (ItemType * item = loaded.items.at (idx)) {
+                self->referenceItem (item, page * pageSize () + idx);
+            }
+        }
+        m_loadedItems += loaded.items.count ();
+        it = m_pages.insert (page, loaded);
+        m_recentPages.append (page);
+        evictPages (page);
+        return it.value ();
+    }
+    /** Delete least recently used pages until the loaded items fit in maxLoadedItems, keptPage excepted */
+    void evictPages (int keptPage) const Q_DECL_FINAL {
+        QQmlPagedObjectListModel * self = const_cast<QQmlPagedObjectListModel *> (this);
+        int idx = 0;
+        while (m_loadedItems > maxLoadedItems () && idx < m_recentPages.count ()) {
+            const int page = m_recentPages.at (idx);
+            if (page == keptPage) {
+                ++idx;
+                continue;
+            }
+            m_recentPages.removeAt (idx);
+            const Page evicted = m_pages.take (page);
+            m_loadedItems -= evicted.items.count ();
+            for (typename QList<ItemType *>::const_iterator it = evicted.items.constBegin (); it != evicted.items.constEnd (); ++it) {
+                self->dereferenceItem (* it);
+            }
+        }
+    }
+    void clearPages (void) {
+        for (typename QHash<int, Page>::const_iterator page = m_pages.constBegin (); page != m_pages.constEnd (); ++page) {
+            for (typename QList<ItemType *>::const_iterator it = page->items.constBegin (); it != page->items.constEnd (); ++it) {
+                dereferenceItem (* it);
+            }
+        }
+        m_pages.clear ();
+        m_recentPages.clear ();
+        m_loadedItems = 0;
+    }
+    void referenceItem (ItemType * item, int row) {
+        if (!item->parent ()) {
+            item->setParent (this);
+        }
+        const QVector<QMetaMethod> & notifyMethods = m_roleTable->notifyMethods ();
+        for (QVector<QMetaMethod>::const_iterator it = notifyMethods.constBegin (); it != notifyMethods.constEnd (); ++it) {
+            connect (item, * it, this, m_handler, Qt::UniqueConnection);
+        }
+        m_rowByItem.insert (item, row);
+    }
+    void dereferenceItem (ItemType * item) {
+        if (item != Q_NULLPTR) {
+            disconnect (item, Q_NULLPTR, this, Q_NULLPTR);
+            m_rowByItem.remove (item);
+            if (item->parent () == this) {
+                item->deleteLater ();
+            }
+        }
+    }
+    void onItemPropertyChanged (void) Q_DECL_FINAL {
+        const int row = m_rowByItem.value (sender (), -1);
+        const QVector<int> & roles = m_roleTable->rolesForSignal (senderSignalIndex ());
+        if (row >= 0 && !roles.isEmpty ()) {
+            const QModelIndex index = QAbstractListModel::index (row, 0, noParent ());
+            emit dataChanged (index, index, roles);
+        }
+    }
+
+private: // data members
+    QQmlModelPageProvider<ItemType> * m_provider;
+    int                               m_count;
+    QSharedPointer<const QQmlObjectRoleTable> m_roleTable;
+    QMetaMethod                       m_handler;
+    mutable int                       m_loadedItems;
+    mutable QHash<int, Page>          m_pages;
+    mutable QList<int>                m_recentPages;
+    QHash<const QObject *, int>       m_rowByItem;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLPAGEDOBJECTLISTMODEL_H
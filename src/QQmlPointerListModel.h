@@ -0,0 +1,1063 @@
+#ifndef QQMLPOINTERLISTMODEL_H
+#define QQMLPOINTERLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMetaMethod>
+#include <QMetaObject>
+#include <QMetaProperty>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <utility>
+
+#include "QQmlModelDataChangeQueue.h"
+#include "QQmlModelEditScript.h"
+#include "QQmlModelRowIndex.h"
+#include "QQmlModelShared.h"
+#include "QQmlModelSort.h"
+#include "QQmlObjectRoleTable.h"
+
+QQMLMODEL_NAMESPACE_START
+
+template<typename T> QList<T> qListFromVariant (const QVariantList & list) {
+    QList<T> ret;
+    ret.reserve (list.size ());
+    for (QVariantList::const_iterator it = list.constBegin (); it != list.constEnd (); ++it) {
+        const QVariant & var = static_cast<QVariant>(* it);
+        ret.append (var.value<T> ());
+    }
+    return ret;
+}
+
+template<typename T> QVariantList qListToVariant (const QList<T> & list) {
+    QVariantList ret;
+    ret.reserve (list.size ());
+    for (typename QList<T>::const_iterator it = list.constBegin (); it != list.constEnd (); ++it) {
+        const T & val = static_cast<T>(* it);
+        ret.append (QVariant::fromValue (val));
+    }
+    return ret;
+}
+
+/**
+ * \internal
+ * What QQmlPointerListModel needs to know of the pointers it holds, and of the pointers
+ * its QML API takes : ItemType * and QObject * for QQmlObjectListModel,
+ * QSharedPointer<ItemType> and QSharedPointer<QObject> for QQmlSharedObjectListModel.
+ */
+template<class Pointer> struct QQmlPointerTraits;
+
+template<class T> struct QQmlPointerTraits<T *> {
+    typedef T         ItemType;
+    typedef QObject * ObjectPointer;
+
+    static T * data (T * item) {
+        return item;
+    }
+    static T * cast (QObject * object) {
+        return qobject_cast<T *> (object);
+    }
+    static QObject * toObject (T * item) {
+        return item;
+    }
+};
+
+template<class T> struct QQmlPointerTraits<QSharedPointer<T> > {
+    typedef T                       ItemType;
+    typedef QSharedPointer<QObject> ObjectPointer;
+
+    static T * data (const QSharedPointer<T> & item) {
+        return item.data ();
+    }
+    static QSharedPointer<T> cast (const QSharedPointer<QObject> & object) {
+        return qSharedPointerObjectCast<T> (object);
+    }
+    static QSharedPointer<QObject> toObject (const QSharedPointer<T> & item) {
+        return item.template staticCast<QObject> ();
+    }
+};
+
+/**
+ * \internal
+ * List logic of the models of QObject pointers : QQmlObjectListModel (Pointer = ItemType *) and
+ * QQmlSharedObjectListModel (Pointer = QSharedPointer<ItemType>). It holds the items, the row and
+ * uid indexes, batching, sorting and the coalesced dataChanged queue.
+ *
+ * Base is the QML base class of the model. Each model only implements the ownership hooks :
+ * releaseItem (), called for every owned item leaving the model, and the slot disposing of
+ * the released items over the next event loop iterations.
+ */
+template<class Pointer, class Base> class QQmlPointerListModel : public Base
+{
+public:
+    typedef QQmlPointerTraits<Pointer>                Traits;
+    typedef typename Traits::ItemType                 ItemType;
+    typedef typename Traits::ObjectPointer            ObjectPointer;
+
+    explicit QQmlPointerListModel (QObject *                 parent,
+                                   const QList<QByteArray> & exposedRoles,
+                                   const QByteArray &        displayRole,
+                                   const QByteArray &        uidRole,
+                                   const char *              className)
+        : Base (parent)
+        , m_count (0)
+        , m_className (className)
+        , m_roleTable (QQmlObjectRoleTable::cached (ItemType::staticMetaObject, exposedRoles, displayRole, uidRole, className))
+        , m_batchActive (false)
+        , m_sortRoleId (-1)
+    { }
+    bool setData (const QModelIndex & index, const QVariant & value, int role) Q_DECL_FINAL {
+        bool ret = false;
+        ItemType * item = Traits::data (visibleItems ().value (index.row ()));
+        if (item != Q_NULLPTR && role != baseRole ()) {
+            ret = m_roleTable->write (item, role, value);
+        }
+        return ret;
+    }
+    QVariant data (const QModelIndex & index, int role) const Q_DECL_FINAL {
+        QVariant ret;
+        const Pointer item = visibleItems ().value (index.row ());
+        if (item != Q_NULLPTR) {
+            ret = (role != baseRole () ? m_roleTable->read (Traits::data (item), role) : QVariant::fromValue (Traits::toObject (item)));
+        }
+        return ret;
+    }
+    QHash<int, QByteArray> roleNames (void) const Q_DECL_FINAL {
+        return m_roleTable->roleNames ();
+    }
+    typedef typename QList<Pointer>::const_iterator const_iterator;
+    const_iterator begin (void) const {
+        return m_items.begin ();
+    }
+    const_iterator end (void) const {
+        return m_items.end ();
+    }
+    const_iterator constBegin (void) const {
+        return m_items.constBegin ();
+    }
+    const_iterator constEnd (void) const {
+        return m_items.constEnd ();
+    }
+
+public: // C++ API
+    Pointer at (int idx) const {
+        Pointer ret = Pointer ();
+        if (idx >= 0 && idx < m_items.size ()) {
+            ret = m_items.value (idx);
+        }
+        return ret;
+    }
+    Pointer getByUid (const QString & uid) const {
+        return (!m_indexByUid.isEmpty () ? m_indexByUid.value (uid) : Pointer ());
+    }
+    int roleForName (const QByteArray & name) const Q_DECL_FINAL {
+        return m_roleTable->roleForName (name);
+    }
+	/** Count of the items the view knows, which doesn't change until a batch is committed */
+	int count (void) const Q_DECL_FINAL {
+        return visibleItems ().count ();
+    }
+	int size (void) const Q_DECL_FINAL {
+        return visibleItems ().count ();
+    }
+	bool isEmpty (void) const Q_DECL_FINAL {
+        return visibleItems ().isEmpty ();
+    }
+	/** Count of the items including the changes of the running batch, same as count () outside of a batch */
+	int pendingCount (void) const {
+        return m_items.count ();
+    }
+	bool contains (const Pointer & item) const {
+        return m_rowIndex.contains (Traits::data (item));
+    }
+	int indexOf (const Pointer & item) const {
+        return m_rowIndex.rowOf (Traits::data (item), m_items);
+    }
+	void clear (void) Q_DECL_FINAL {
+        if (!m_items.isEmpty () && !this->isBatching ()) {
+            resetItems (QList<Pointer> ());
+        }
+        else if (!m_items.isEmpty ()) {
+			const QList<Pointer> tempList = m_items;
+			for (int i = 0; i < tempList.count(); ++i)
+				itemAboutToBeRemoved(tempList.at(i), i);
+            beginRemove (0, m_items.count () -1);
+            for (typename QList<Pointer>::const_iterator it = tempList.constBegin (); it != tempList.constEnd (); ++it) {
+                dereferenceItem (* it);
+            }
+            m_items.clear ();
+            m_rowIndex.clear ();
+            m_dataChangedQueue.clear ();
+            updateCounter ();
+            endRemove ();
+			for (int i = 0; i < tempList.count(); ++i)
+				itemRemoved(tempList.at(i), i);
+        }
+    }
+	void append (const Pointer & item) {
+        if (isAutoSorted ()) {
+            insert (0, item);
+        }
+        else if (item != Q_NULLPTR) {
+            const int pos = m_items.count ();
+			itemAboutToBeInserted(item, pos);
+            beginInsert (pos, pos);
+            m_items.append (item);
+            m_rowIndex.insert (Traits::data (item), pos, m_items.count ());
+            referenceItem (item);
+            updateCounter ();
+            endInsert ();
+			itemInserted(item, pos);
+        }
+    }
+	void prepend (const Pointer & item) {
+        if (isAutoSorted ()) {
+            insert (0, item);
+        }
+        else if (item != Q_NULLPTR) {
+			itemAboutToBeInserted(item, 0);
+            beginInsert (0, 0);
+            m_items.prepend (item);
+            m_rowIndex.insert (Traits::data (item), 0, m_items.count ());
+            referenceItem (item);
+            updateCounter ();
+            endInsert ();
+			itemInserted(item, 0);
+        }
+    }
+	void insert (int idx, const Pointer & item) {
+        if (item != Q_NULLPTR) {
+            if (isAutoSorted ()) {
+                idx = sortedRow (m_roleTable->read (Traits::data (item), m_sortRoleId), 0, m_items.count ());
+            }
+			itemAboutToBeInserted(item, idx);
+            beginInsert (idx, idx);
+            m_items.insert (idx, item);
+            m_rowIndex.insert (Traits::data (item), idx, m_items.count ());
+            referenceItem (item);
+            updateCounter ();
+            endInsert ();
+			itemInserted(item, idx);
+        }
+    }
+	void append (const QList<Pointer> & itemList) {
+        insertItems (m_items.count (), itemList, false);
+    }
+	void prepend (const QList<Pointer> & itemList) {
+        insertItems (0, itemList, false);
+    }
+	void insert (int idx, const QList<Pointer> & itemList) {
+        insertItems (idx, itemList, false);
+    }
+	/** Same as append (itemList), the list storage is reused when the model is empty */
+	void append (QList<Pointer> && itemList) {
+        insertItems (m_items.count (), std::move (itemList), true);
+    }
+	/** Same as prepend (itemList), the current items are appended to the storage of itemList */
+	void prepend (QList<Pointer> && itemList) {
+        insertItems (0, std::move (itemList), true);
+    }
+	/** Same as insert (idx, itemList), the storage of itemList is reused when inserting at 0 */
+	void insert (int idx, QList<Pointer> && itemList) {
+        insertItems (idx, std::move (itemList), true);
+    }
+	/** Replace the content of the model by itemList, emitting only the removals, moves and insertions
+	 * needed to go from the current list to the new one, so delegates of kept items survive.
+	 * Items are matched by pointer. When the model has a uid role, an incoming item whose uid is
+	 * the one of a current item takes its row in place : the current item is released like on removal
+	 * and the row is notified with dataChanged. Items are expected to be unique in itemList.
+	 * When itemList shares no item with the model, nothing is worth keeping and the model is reset instead. */
+	void setItems (const QList<Pointer> & itemList) {
+        if (!this->isBatching () && !m_items.isEmpty () && !sharesItems (itemList)) {
+            resetItems (itemList);
+            if (isAutoSorted ()) {
+                sortByRole (this->sortRole (), this->sortOrder ());
+            }
+            return;
+        }
+        QSet<const QObject *> incoming;
+        incoming.reserve (itemList.count ());
+        for (typename QList<Pointer>::const_iterator it = itemList.constBegin (); it != itemList.constEnd (); ++it) {
+            incoming.insert (Traits::data (* it));
+        }
+        this->beginBatch ();
+        if (m_roleTable->uidProperty ().isValid () && !m_indexByUid.isEmpty ()) {
+            for (typename QList<Pointer>::const_iterator it = itemList.constBegin (); it != itemList.constEnd (); ++it) {
+                if (* it == Q_NULLPTR || contains (* it)) {
+                    continue;
+                }
+                const Pointer current = m_indexByUid.value (m_roleTable->uidProperty ().read (Traits::data (* it)).toString ());
+                if (current != Q_NULLPTR && !incoming.contains (Traits::data (current)) && !m_batchReplacements.contains (Traits::data (current))) {
+                    m_batchReplacements.insert (Traits::data (current), * it);
+                }
+            }
+        }
+        QList<Pointer> added;
+        for (typename QList<Pointer>::const_iterator it = itemList.constBegin (); it != itemList.constEnd (); ++it) {
+            if (!contains (* it)) {
+                added.append (* it);
+            }
+        }
+        for (typename QList<Pointer>::const_iterator it = m_items.constBegin (); it != m_items.constEnd (); ++it) {
+            if (!incoming.contains (Traits::data (* it))) {
+                dereferenceItem (* it);
+            }
+        }
+        m_items = itemList;
+        rebuildRowIndex ();
+        for (typename QList<Pointer>::const_iterator it = added.constBegin (); it != added.constEnd (); ++it) {
+            referenceItem (* it);
+        }
+        if (isAutoSorted ()) {
+            sortByRole (this->sortRole (), this->sortOrder ());
+        }
+        this->endBatch ();
+    }
+	void move (int idx, int pos) Q_DECL_FINAL {
+        if (idx != pos && idx >=0 && pos>=0 && idx < m_items.size() && pos < m_items.size()) {
+			itemAboutToBeMoved(m_items.at(idx), idx, pos);
+            beginMove (idx, pos);
+            m_items.move (idx, pos);
+            m_rowIndex.move (idx, pos);
+            endMove ();
+			itemMoved(m_items.at(pos), idx, pos);
+        }
+    }
+	void remove (const Pointer & item) {
+        if (item != Q_NULLPTR) {
+            const int idx = indexOf (item);
+            remove (idx);
+        }
+    }
+	void remove (int idx) Q_DECL_FINAL {
+        if (idx >= 0 && idx < m_items.size ()) {
+			itemAboutToBeRemoved(m_items.at(idx), idx);
+            beginRemove (idx, idx);
+            const Pointer item = m_items.takeAt (idx);
+            m_rowIndex.remove (Traits::data (item), idx);
+            dereferenceItem (item);
+            updateCounter ();
+            endRemove ();
+			itemRemoved(item, idx);
+        }
+    }
+	void removeRange (int first, int count) Q_DECL_FINAL {
+        removeItems (first, count, true);
+    }
+	/** Removes count items starting at index position first and returns them.
+	 * The caller takes ownership of the items the model owned, they aren't released */
+	QList<Pointer> takeRange (int first, int count) {
+        return removeItems (first, count, false);
+    }
+	/** Removes every item for which predicate (item) returns true, and returns how many were removed.
+	 * The storage is compacted in a single pass and each contiguous run of removed rows is notified once */
+	template<class Predicate> int removeIf (Predicate predicate) {
+        QList<Pointer> kept;
+        kept.reserve (m_items.count ());
+        QList<Pointer> removed;
+        for (typename QList<Pointer>::const_iterator it = m_items.constBegin (); it != m_items.constEnd (); ++it) {
+            if (predicate (* it)) {
+                removed.append (* it);
+            }
+            else {
+                kept.append (* it);
+            }
+        }
+        if (!removed.isEmpty ()) {
+            this->beginBatch ();
+            m_items.swap (kept);
+            rebuildRowIndex ();
+            for (typename QList<Pointer>::const_iterator it = removed.constBegin (); it != removed.constEnd (); ++it) {
+                dereferenceItem (* it);
+            }
+            this->endBatch ();
+        }
+        return removed.count ();
+    }
+	void sortByRole (const QString & role, Qt::SortOrder order = Qt::AscendingOrder) Q_DECL_FINAL {
+        sortByRoles (QStringList (role), order);
+    }
+	void sortByRoles (const QStringList & roles, Qt::SortOrder order = Qt::AscendingOrder) Q_DECL_FINAL {
+        QVector<int> sortRoles;
+        sortRoles.reserve (roles.count ());
+        for (QStringList::const_iterator it = roles.constBegin (); it != roles.constEnd (); ++it) {
+            const int role = m_roleTable->roleForName (it->toUtf8 ());
+            if (role < 0) {
+                qWarning ("%s::sortByRoles : Can't sort by unknown role %s", m_className, qPrintable (* it));
+                return;
+            }
+            sortRoles.append (role);
+        }
+        if (sortRoles.isEmpty () || m_items.count () < 2) {
+            return;
+        }
+        // Read every key once, the comparisons then never go through the meta object
+        const int stride = sortRoles.count ();
+        QVector<QVariant> keys;
+        keys.reserve (m_items.count () * stride);
+        for (int row = 0; row < m_items.count (); ++row) {
+            for (QVector<int>::const_iterator role = sortRoles.constBegin (); role != sortRoles.constEnd (); ++role) {
+                keys.append (m_roleTable->read (Traits::data (m_items.at (row)), * role));
+            }
+        }
+        applyPermutation (QQmlModelSort::permutation (m_items.count (), QQmlModelSort::KeyLessThan (keys, stride, order), true));
+    }
+	/** Sort the items with lessThan (a, b), called with two items of the model. Items comparing equal keep their order */
+	template<class LessThan> void sort (LessThan lessThan) {
+        const QList<Pointer> & items = m_items;
+        applyPermutation (QQmlModelSort::permutation (m_items.count (), [&] (int a, int b) {
+            return lessThan (items.at (a), items.at (b));
+        }, false));
+    }
+    Pointer first (void) const {
+        return m_items.first ();
+    }
+    Pointer last (void) const {
+        return m_items.last ();
+    }
+    const QList<Pointer> & toList (void) const {
+        return m_items;
+    }
+
+public: // QML slots implementation
+    void append (ObjectPointer item) Q_DECL_FINAL {
+        append (Traits::cast (item));
+    }
+    void prepend (ObjectPointer item) Q_DECL_FINAL {
+        prepend (Traits::cast (item));
+    }
+    void insert (int idx, ObjectPointer item) Q_DECL_FINAL {
+        insert (idx, Traits::cast (item));
+    }
+    void remove (ObjectPointer item) Q_DECL_FINAL {
+        remove (Traits::cast (item));
+    }
+    bool contains (ObjectPointer item) const Q_DECL_FINAL {
+        return contains (Traits::cast (item));
+    }
+    int indexOf (ObjectPointer item) const Q_DECL_FINAL {
+        return indexOf (Traits::cast (item));
+    }
+    int indexOf (const QString & uid) const {
+        return indexOf (getByUid (uid));
+    }
+    ObjectPointer get (int idx) const Q_DECL_FINAL {
+        return Traits::toObject (at (idx));
+    }
+    ObjectPointer get (const QString & uid) const Q_DECL_FINAL {
+        return Traits::toObject (getByUid (uid));
+    }
+    ObjectPointer getFirst (void) const Q_DECL_FINAL {
+        return Traits::toObject (first ());
+    }
+    ObjectPointer getLast (void) const Q_DECL_FINAL {
+        return Traits::toObject (last ());
+    }
+    QVariantList toVarArray (void) const Q_DECL_FINAL {
+        return qListToVariant<Pointer> (m_items);
+    }
+    void flushDataChanged (void) Q_DECL_FINAL {
+        if (this->isBatching ()) { // rows are resolved against the list the view knows, flushed on commit
+            return;
+        }
+        m_dataChangedQueue.flush (m_rowIndex, m_items, [this] (int first, int last, const QVector<int> & roles) {
+            emit this->dataChanged (this->index (first, 0, noParent ()), this->index (last, 0, noParent ()), roles);
+        });
+    }
+
+protected: // ownership hooks
+	/** Dispose of item, owned by the model, once it left the model for good.
+	 * connected tells that it's still connected to the model */
+	virtual void releaseItem (const Pointer & item, bool connected) = 0;
+
+protected: // internal stuff
+    static const QModelIndex & noParent (void) {
+        static const QModelIndex ret = QModelIndex ();
+        return ret;
+    }
+    static int baseRole (void) {
+        return QQmlObjectRoleTable::baseRole ();
+    }
+    int rowCount (const QModelIndex & parent = QModelIndex ()) const Q_DECL_FINAL {
+        return (!parent.isValid () ? visibleItems ().count () : 0);
+    }
+    /** Take ownership of item and connect it. uid, when given, is its precomputed uid key,
+     * and connected tells that its notify signals are already connected to the model */
+    void referenceItem (const Pointer & item, const QString * uid = Q_NULLPTR, bool connected = false) {
+        if (item != Q_NULLPTR) {
+            if (!item->parent ()) {
+                item->setParent (this);
+            }
+            if (!connected) {
+                const QVector<QMetaMethod> & notifyMethods = m_roleTable->notifyMethods ();
+                for (int idx = 0; idx < notifyMethods.count (); ++idx) {
+                    QMetaObject::connect (Traits::data (item), notifyMethods.at (idx).methodIndex (), this, notifySlot () + idx, Qt::UniqueConnection);
+                }
+            }
+            if (m_roleTable->uidProperty ().isValid ()) {
+                if (uid != Q_NULLPTR) {
+                    indexUid (item, * uid);
+                }
+                else {
+                    indexUid (item);
+                }
+            }
+        }
+    }
+    /** Disconnect item from the model. When destroy is false, an owned item is given up to the caller instead of released */
+    void dereferenceItem (const Pointer & item, bool destroy = true) {
+        if (item != Q_NULLPTR) {
+            QObject::disconnect (this, Q_NULLPTR, Traits::data (item), Q_NULLPTR);
+            QObject::disconnect (Traits::data (item), Q_NULLPTR, this, Q_NULLPTR);
+            m_dataChangedQueue.remove (Traits::data (item));
+            if (m_roleTable->uidProperty ().isValid ()) {
+                unindexUid (item);
+            }
+            if (item->parent () == this) { // FIXME : maybe that's not the best way to test ownership ?
+                if (!destroy) {
+                    item->setParent (Q_NULLPTR);
+                }
+                else if (this->isBatching ()) { // the view may still show it until the batch is committed
+                    m_batchRemovedItems.append (item);
+                }
+                else {
+                    releaseItem (item, false);
+                }
+            }
+        }
+    }
+    /** Whether any item of itemList is in the model, or would replace one by uid */
+    bool sharesItems (const QList<Pointer> & itemList) const {
+        const bool byUid = (m_roleTable->uidProperty ().isValid () && !m_indexByUid.isEmpty ());
+        for (typename QList<Pointer>::const_iterator it = itemList.constBegin (); it != itemList.constEnd (); ++it) {
+            if (* it != Q_NULLPTR && (contains (* it) || (byUid && m_indexByUid.contains (m_roleTable->uidProperty ().read (Traits::data (* it)).toString ())))) {
+                return true;
+            }
+        }
+        return false;
+    }
+    /** Replace every item by itemList, which shares no item with the model, with a single model reset.
+     * The previous items are released in bulk : the uid index and pending notifications are dropped at once,
+     * and owned items are left connected to releaseItem (), which disconnects them only if their disposal doesn't */
+    void resetItems (const QList<Pointer> & itemList) {
+        const QList<Pointer> previous = m_items;
+        for (int i = 0; i < previous.count (); ++i)
+            itemAboutToBeRemoved (previous.at (i), i);
+        for (int i = 0; i < itemList.count (); ++i)
+            itemAboutToBeInserted (itemList.at (i), i);
+        this->beginResetModel ();
+        m_items = itemList;
+        rebuildRowIndex ();
+        m_dataChangedQueue.clear ();
+        m_indexByUid.clear ();
+        m_uidByItem.clear ();
+        for (typename QList<Pointer>::const_iterator it = previous.constBegin (); it != previous.constEnd (); ++it) {
+            const Pointer & item = (* it);
+            if (item == Q_NULLPTR) {
+                continue;
+            }
+            else if (item->parent () == this) {
+                releaseItem (item, true); // signals of an item out of the model are ignored until then
+            }
+            else {
+                QObject::disconnect (Traits::data (item), Q_NULLPTR, this, Q_NULLPTR);
+            }
+        }
+        for (typename QList<Pointer>::const_iterator it = m_items.constBegin (); it != m_items.constEnd (); ++it) {
+            referenceItem (* it);
+        }
+        updateCounter ();
+        this->endResetModel ();
+        for (int i = 0; i < previous.count (); ++i)
+            itemRemoved (previous.at (i), i);
+        for (int i = 0; i < m_items.count (); ++i)
+            itemInserted (m_items.at (i), i);
+    }
+    /** Index every row of m_items from scratch, after the whole list was replaced */
+    void rebuildRowIndex (void) {
+        m_rowIndex.clear ();
+        m_rowIndex.reserve (m_items.count ());
+        for (int row = 0; row < m_items.count (); ++row) {
+            m_rowIndex.insert (Traits::data (m_items.at (row)), row, row +1);
+        }
+    }
+    /** Method index of the slot the first notify signal of the role table is connected to.
+     * Base has no such slots : qt_metacall () routes them by their index */
+    static int notifySlot (void) {
+        return Base::staticMetaObject.methodCount ();
+    }
+    /** The slot index of a notify signal gives its roles without senderSignalIndex (), the row index the row */
+    int qt_metacall (QMetaObject::Call call, int id, void ** args) Q_DECL_OVERRIDE {
+        id = Base::qt_metacall (call, id, args);
+        if (id >= 0 && call == QMetaObject::InvokeMetaMethod) {
+            const int notifyCount = m_roleTable->notifyMethods ().count ();
+            if (id < notifyCount) {
+                onItemPropertyChanged (m_roleTable->rolesForNotify (id));
+            }
+            id -= notifyCount;
+        }
+        return id;
+    }
+    void onItemPropertyChanged (const QVector<int> & roles) {
+        int row = m_rowIndex.rowOf (this->sender (), m_items);
+        if (row < 0 || roles.isEmpty ()) {
+            return;
+        }
+        const Pointer item = m_items.at (row);
+        if (isAutoSorted () && roles.contains (m_sortRoleId)) {
+            row = repositionItem (row);
+        }
+        if (this->coalesceDataChanged () || this->isBatching ()) {
+            bool schedule = false;
+            for (QVector<int>::const_iterator it = roles.constBegin (); it != roles.constEnd (); ++it) {
+                schedule = (m_dataChangedQueue.append (Traits::data (item), * it) || schedule);
+            }
+            if (schedule && !this->isBatching ()) {
+                QMetaObject::invokeMethod (this, "flushDataChanged", Qt::QueuedConnection);
+            }
+        }
+        else {
+            const QModelIndex index = this->index (row, 0, noParent ());
+            emit this->dataChanged (index, index, roles);
+        }
+        if (m_roleTable->uidRole () >= 0 && roles.contains (m_roleTable->uidRole ())) {
+            indexUid (item);
+        }
+    }
+    /** Store the current uid of item, dropping its previous one. O(1) thanks to the reverse uid map */
+    void indexUid (const Pointer & item) {
+        indexUid (item, m_roleTable->uidProperty ().read (Traits::data (item)).toString ());
+    }
+    void indexUid (const Pointer & item, const QString & value) {
+        typename QHash<const QObject *, QString>::iterator it = m_uidByItem.find (Traits::data (item));
+        if (it != m_uidByItem.end ()) {
+            if (it.value () == value) {
+                return;
+            }
+            // Another item may have claimed the same uid since, only drop the entry if it's still ours
+            if (m_indexByUid.value (it.value ()) == item) {
+                m_indexByUid.remove (it.value ());
+            }
+            m_uidByItem.erase (it);
+        }
+        if (!value.isEmpty ()) {
+            m_indexByUid.insert (value, item);
+            m_uidByItem.insert (Traits::data (item), value);
+        }
+    }
+    void unindexUid (const Pointer & item) {
+        typename QHash<const QObject *, QString>::iterator it = m_uidByItem.find (Traits::data (item));
+        if (it != m_uidByItem.end ()) {
+            if (m_indexByUid.value (it.value ()) == item) {
+                m_indexByUid.remove (it.value ());
+            }
+            m_uidByItem.erase (it);
+        }
+    }
+    bool isAutoSorted (void) const {
+        return (m_sortRoleId >= 0);
+    }
+    void updateSortRole (void) Q_DECL_FINAL {
+        m_sortRoleId = (!this->sortRole ().isEmpty () ? m_roleTable->roleForName (this->sortRole ().toUtf8 ()) : -1);
+        if (m_sortRoleId >= 0) {
+            sortByRole (this->sortRole (), this->sortOrder ());
+        }
+        else if (!this->sortRole ().isEmpty ()) {
+            qWarning ("%s::setSortRole : Can't sort by unknown role %s", m_className, qPrintable (this->sortRole ()));
+        }
+    }
+    /** Whether key a goes before key b in sortOrder */
+    bool sortsBefore (const QVariant & a, const QVariant & b) const {
+        const int cmp = QQmlModelSort::compare (a, b);
+        return (this->sortOrder () == Qt::AscendingOrder ? cmp < 0 : cmp > 0);
+    }
+    /** First row in [first, last) whose sort key goes after key, last if none. Binary search */
+    int sortedRow (const QVariant & key, int first, int last) const {
+        while (first < last) {
+            const int mid = (first + (last - first) / 2);
+            if (sortsBefore (key, m_roleTable->read (Traits::data (m_items.at (mid)), m_sortRoleId))) {
+                last = mid;
+            }
+            else {
+                first = mid +1;
+            }
+        }
+        return first;
+    }
+    /** Move the item at row to its sorted row after its sort key changed, returns its new row.
+     * Items are only moved past neighbours they are out of order with, so equal items keep their order */
+    int repositionItem (int row) {
+        const QVariant key = m_roleTable->read (Traits::data (m_items.at (row)), m_sortRoleId);
+        int dest = row;
+        if (row > 0 && sortsBefore (key, m_roleTable->read (Traits::data (m_items.at (row -1)), m_sortRoleId))) {
+            dest = sortedRow (key, 0, row);
+        }
+        else if (row +1 < m_items.count () && sortsBefore (m_roleTable->read (Traits::data (m_items.at (row +1)), m_sortRoleId), key)) {
+            dest = (sortedRow (key, row +1, m_items.count ()) -1);
+        }
+        if (dest != row) {
+            move (row, dest);
+        }
+        return dest;
+    }
+    /** Merge itemList into the sorted items : itemList is sorted on its own, then each item is
+     * placed with a binary search starting after the previous one, and the runs of new rows are
+     * notified at once */
+    void insertSorted (const QList<Pointer> & itemList) {
+        QList<Pointer> incoming;
+        incoming.reserve (itemList.count ());
+        QVector<QVariant> keys;
+        keys.reserve (itemList.count ());
+        for (typename QList<Pointer>::const_iterator it = itemList.constBegin (); it != itemList.constEnd (); ++it) {
+            if (* it != Q_NULLPTR) {
+                incoming.append (* it);
+                keys.append (m_roleTable->read (Traits::data (* it), m_sortRoleId));
+            }
+        }
+        if (incoming.isEmpty ()) {
+            return;
+        }
+        const QVector<int> order = QQmlModelSort::permutation (incoming.count (), QQmlModelSort::KeyLessThan (keys, 1, this->sortOrder ()), true);
+        QList<Pointer> merged;
+        merged.reserve (m_items.count () + incoming.count ());
+        int row = 0;
+        for (QVector<int>::const_iterator it = order.constBegin (); it != order.constEnd (); ++it) {
+            const int next = sortedRow (keys.at (* it), row, m_items.count ());
+            for (; row < next; ++row) {
+                merged.append (m_items.at (row));
+            }
+            merged.append (incoming.at (* it));
+        }
+        for (; row < m_items.count (); ++row) {
+            merged.append (m_items.at (row));
+        }
+        this->beginBatch ();
+        m_items.swap (merged);
+        rebuildRowIndex ();
+        for (typename QList<Pointer>::const_iterator it = incoming.constBegin (); it != incoming.constEnd (); ++it) {
+            referenceItem (* it);
+        }
+        this->endBatch ();
+    }
+    /** Reorder the items so that row becomes permutation [row], with a single layout change */
+    void applyPermutation (const QVector<int> & permutation) {
+        bool identity = true;
+        for (int row = 0; row < permutation.count () && identity; ++row) {
+            identity = (permutation.at (row) == row);
+        }
+        if (identity) {
+            return;
+        }
+        QList<Pointer> sorted;
+        sorted.reserve (m_items.count ());
+        for (QVector<int>::const_iterator it = permutation.constBegin (); it != permutation.constEnd (); ++it) {
+            sorted.append (m_items.at (* it));
+        }
+        if (this->isBatching ()) { // moves are notified when the batch is committed
+            m_items.swap (sorted);
+            m_rowIndex.invalidate (0);
+            return;
+        }
+        emit this->layoutAboutToBeChanged (QList<QPersistentModelIndex> (), QAbstractItemModel::VerticalSortHint);
+        m_items.swap (sorted);
+        m_rowIndex.invalidate (0);
+        QVector<int> newRows (permutation.count ());
+        for (int row = 0; row < permutation.count (); ++row) {
+            newRows [permutation.at (row)] = row;
+        }
+        const QModelIndexList from = this->persistentIndexList ();
+        QModelIndexList to;
+        to.reserve (from.count ());
+        for (QModelIndexList::const_iterator it = from.constBegin (); it != from.constEnd (); ++it) {
+            to.append (this->index (newRows.value (it->row ()), it->column (), noParent ()));
+        }
+        this->changePersistentIndexList (from, to);
+        emit this->layoutChanged (QList<QPersistentModelIndex> (), QAbstractItemModel::VerticalSortHint);
+    }
+    /** Remove the rows [first, first + count) with a single notification and return their items */
+    QList<Pointer> removeItems (int first, int count, bool destroy) {
+        QList<Pointer> ret;
+        if (first < 0 || count <= 0 || first >= m_items.count ()) {
+            return ret;
+        }
+        const int last = (qMin (first + count, m_items.count ()) -1);
+        ret = m_items.mid (first, last - first +1);
+        for (int i = 0; i < ret.count (); ++i)
+            itemAboutToBeRemoved (ret.at (i), first + i);
+        beginRemove (first, last);
+        m_items.erase (m_items.begin () + first, m_items.begin () + last +1);
+        for (typename QList<Pointer>::const_iterator it = ret.constBegin (); it != ret.constEnd (); ++it) {
+            m_rowIndex.remove (Traits::data (* it), first);
+            dereferenceItem (* it, destroy);
+        }
+        updateCounter ();
+        endRemove ();
+        for (int i = 0; i < ret.count (); ++i)
+            itemRemoved (ret.at (i), first + i);
+        return ret;
+    }
+    /** Splice itemList in at idx, building the new storage once. adopt allows reusing the storage of itemList, uids and connected are
+     * the precomputed uid keys of the items and whether they are connected already, see referenceItem () */
+    void insertItems (int idx, QList<Pointer> itemList, bool adopt, const QStringList * uids = Q_NULLPTR, bool connected = false) {
+        if (itemList.isEmpty ()) {
+            return;
+        }
+        if (isAutoSorted ()) {
+            insertSorted (itemList);
+            return;
+        }
+        idx = qBound (0, idx, m_items.count ());
+        const int count = itemList.count ();
+        for (int i = 0; i < count; ++i)
+            itemAboutToBeInserted (itemList.at (i), i + idx);
+        beginInsert (idx, idx + count -1);
+        if (idx == m_items.count ()) {
+            if (adopt && m_items.isEmpty ()) {
+                m_items.swap (itemList);
+            }
+            else {
+                m_items.append (itemList);
+            }
+        }
+        else if (adopt && idx == 0) {
+            itemList.append (m_items);
+            m_items.swap (itemList);
+        }
+        else {
+            QList<Pointer> spliced;
+            spliced.reserve (m_items.count () + count);
+            for (int row = 0; row < idx; ++row) {
+                spliced.append (m_items.at (row));
+            }
+            spliced.append (itemList);
+            for (int row = idx; row < m_items.count (); ++row) {
+                spliced.append (m_items.at (row));
+            }
+            m_items.swap (spliced);
+        }
+        // Count the list had when each item would have been inserted one by one, so appends keep the index valid
+        const int firstCount = (m_items.count () - count +1);
+        m_rowIndex.reserve (m_items.count ());
+        for (int row = idx; row < idx + count; ++row) {
+            m_rowIndex.insert (Traits::data (m_items.at (row)), row, firstCount + row - idx);
+        }
+        for (int row = idx; row < idx + count; ++row) {
+            referenceItem (m_items.at (row), (uids != Q_NULLPTR ? &uids->at (row - idx) : Q_NULLPTR), connected);
+        }
+        updateCounter ();
+        endInsert ();
+        for (int row = idx; row < idx + count; ++row)
+            itemInserted (m_items.at (row), row);
+    }
+    void startBatch (void) Q_DECL_FINAL {
+        // The view keeps seeing the list as it was until the batch is committed
+        m_committedItems = m_items;
+        m_batchActive = true;
+    }
+    void commitBatch (void) Q_DECL_FINAL {
+        QVector<int> targetRows;
+        targetRows.reserve (m_committedItems.count ());
+        for (typename QList<Pointer>::const_iterator it = m_committedItems.constBegin (); it != m_committedItems.constEnd (); ++it) {
+            int row = m_rowIndex.rowOf (QQmlModelRowIndex::keyOf (* it), m_items);
+            if (row < 0 && !m_batchReplacements.isEmpty ()) { // the item gives its row to the one that replaced it
+                row = m_rowIndex.rowOf (QQmlModelRowIndex::keyOf (m_batchReplacements.value (QQmlModelRowIndex::keyOf (* it))), m_items);
+            }
+            targetRows.append (row);
+        }
+        applyEdits (QQmlModelEditScript::compute (targetRows, m_items.count ()));
+        applyReplacements ();
+        m_committedItems.clear ();
+        m_batchActive = false;
+        for (typename QList<Pointer>::const_iterator it = m_batchRemovedItems.constBegin (); it != m_batchRemovedItems.constEnd (); ++it) {
+            if (!contains (* it) && (* it)->parent () == this) {
+                releaseItem (* it, false);
+            }
+        }
+        m_batchRemovedItems.clear ();
+        updateCounter ();
+        if (!this->coalesceDataChanged ()) {
+            flushDataChanged ();
+        }
+        else if (!m_dataChangedQueue.isEmpty ()) {
+            QMetaObject::invokeMethod (this, "flushDataChanged", Qt::QueuedConnection);
+        }
+    }
+    /** Swap the items replaced by uid in the list known by the view, then notify their rows */
+    void applyReplacements (void) {
+        if (m_batchReplacements.isEmpty ()) {
+            return;
+        }
+        QList<Pointer> & shown = m_committedItems;
+        QVector<int> rows;
+        for (typename QHash<const QObject *, Pointer>::const_iterator it = m_batchReplacements.constBegin (); it != m_batchReplacements.constEnd (); ++it) {
+            const int row = m_rowIndex.rowOf (QQmlModelRowIndex::keyOf (it.value ()), m_items);
+            if (row >= 0 && row < shown.count () && QQmlModelRowIndex::keyOf (shown.at (row)) == it.key ()) {
+                const Pointer previous = shown.at (row);
+                itemAboutToBeRemoved (previous, row);
+                itemAboutToBeInserted (it.value (), row);
+                shown [row] = it.value ();
+                itemRemoved (previous, row);
+                itemInserted (it.value (), row);
+                rows.append (row);
+            }
+        }
+        m_batchReplacements.clear ();
+        std::sort (rows.begin (), rows.end ());
+        for (int idx = 0; idx < rows.count ();) {
+            const int first = rows.at (idx);
+            int last = first;
+            for (++idx; idx < rows.count () && rows.at (idx) == last +1; ++idx) {
+                ++last;
+            }
+            emit this->dataChanged (this->index (first, 0, noParent ()), this->index (last, 0, noParent ()));
+        }
+    }
+    /** Replay edits on the list known by the view until it matches m_items */
+    void applyEdits (const QVector<QQmlModelEdit> & edits) {
+        QList<Pointer> & shown = m_committedItems;
+        for (QVector<QQmlModelEdit>::const_iterator edit = edits.constBegin (); edit != edits.constEnd (); ++edit) {
+            switch (edit->type) {
+            case QQmlModelEdit::Remove: {
+                const QList<Pointer> removed = shown.mid (edit->first, edit->last - edit->first +1);
+                for (int i = 0; i < removed.count (); ++i)
+                    itemAboutToBeRemoved (removed.at (i), edit->first + i);
+                this->beginRemoveRows (noParent (), edit->first, edit->last);
+                shown.erase (shown.begin () + edit->first, shown.begin () + edit->last +1);
+                this->endRemoveRows ();
+                for (int i = 0; i < removed.count (); ++i)
+                    itemRemoved (removed.at (i), edit->first + i);
+                break;
+            }
+            case QQmlModelEdit::Move: {
+                const Pointer item = shown.at (edit->first);
+                itemAboutToBeMoved (item, edit->first, edit->dest);
+                this->beginMoveRows (noParent (), edit->first, edit->first, noParent (), (edit->first < edit->dest ? edit->dest +1 : edit->dest));
+                shown.move (edit->first, edit->dest);
+                this->endMoveRows ();
+                itemMoved (item, edit->first, edit->dest);
+                break;
+            }
+            case QQmlModelEdit::Insert: {
+                const QList<Pointer> inserted = m_items.mid (edit->first, edit->last - edit->first +1);
+                for (int i = 0; i < inserted.count (); ++i)
+                    itemAboutToBeInserted (inserted.at (i), edit->first + i);
+                this->beginInsertRows (noParent (), edit->first, edit->last);
+                QList<Pointer> tail = shown.mid (edit->first);
+                shown.erase (shown.begin () + edit->first, shown.end ());
+                shown.append (inserted);
+                shown.append (tail);
+                this->endInsertRows ();
+                for (int i = 0; i < inserted.count (); ++i)
+                    itemInserted (inserted.at (i), edit->first + i);
+                break;
+            }
+            }
+        }
+    }
+    /** List the view knows about, differs from m_items only during a batch */
+    const QList<Pointer> & visibleItems (void) const {
+        return (m_batchActive ? m_committedItems : m_items);
+    }
+    void beginInsert (int first, int last) {
+        if (!this->isBatching ()) {
+            this->beginInsertRows (noParent (), first, last);
+        }
+    }
+    void endInsert (void) {
+        if (!this->isBatching ()) {
+            this->endInsertRows ();
+        }
+    }
+    void beginRemove (int first, int last) {
+        if (!this->isBatching ()) {
+            this->beginRemoveRows (noParent (), first, last);
+        }
+    }
+    void endRemove (void) {
+        if (!this->isBatching ()) {
+            this->endRemoveRows ();
+        }
+    }
+    /** Same arguments as QList::move */
+    void beginMove (int src, int dest) {
+        if (!this->isBatching ()) {
+            this->beginMoveRows (noParent (), src, src, noParent (), (src < dest ? dest +1 : dest));
+        }
+    }
+    void endMove (void) {
+        if (!this->isBatching ()) {
+            this->endMoveRows ();
+        }
+    }
+    inline void updateCounter (void) {
+        if (!this->isBatching () && m_count != m_items.count ()) {
+            m_count = m_items.count ();
+            emit this->countChanged ();
+        }
+    }
+
+private:
+	void itemAboutToBeInserted(const Pointer & item, int row) { if (!this->isBatching ()) { onItemAboutToBeInserted(item, row); emit Base::itemAboutToBeInserted(item, row); } }
+	void itemInserted(const Pointer & item, int row) { if (!this->isBatching ()) { onItemInserted(item, row); emit Base::itemInserted(item, row); } }
+	void itemAboutToBeMoved(const Pointer & item, int src, int dest) { if (!this->isBatching ()) { onItemAboutToBeMoved(item, src, dest); emit Base::itemAboutToBeMoved(item, src, dest); } }
+	void itemMoved(const Pointer & item, int src, int dest) { if (!this->isBatching ()) { onItemMoved(item, src, dest); emit Base::itemMoved(item, src, dest); } }
+	void itemAboutToBeRemoved(const Pointer & item, int row) { if (!this->isBatching ()) { onItemAboutToBeRemoved(item, row); emit Base::itemAboutToBeRemoved(item, row); } }
+	void itemRemoved(const Pointer & item, int row) { if (!this->isBatching ()) { onItemRemoved(item, row); emit Base::itemRemoved(item, row); } }
+
+protected:
+	virtual void onItemAboutToBeInserted(Pointer item, int row) { }
+	virtual void onItemInserted(Pointer item, int row) { }
+	virtual void onItemAboutToBeMoved(Pointer item, int src, int dest) { }
+	virtual void onItemMoved(Pointer item, int src, int dest) { }
+	virtual void onItemAboutToBeRemoved(Pointer item, int row) { }
+	virtual void onItemRemoved(Pointer item, int row) { }
+
+private:
+	/** Move row to row-1 */
+	void moveUp(const int row) override final
+    {
+		if (row > 0 && row < m_items.count ())
+			move(row, row - 1);
+    }
+
+	/** Move row to row+1 */
+	void moveDown(const int row) override final
+    {
+		if (!m_items.isEmpty () && // There is a least one entry
+			row >= 0 && // We can be from the first
+			row < (m_items.count () - 1) // To the last one minus 1
+			)
+		{
+			return moveUp(row + 1);
+		}
+    }
+
+protected: // data members
+    int                                  m_count;
+    const char *                         m_className;
+    QSharedPointer<const QQmlObjectRoleTable> m_roleTable;
+    QList<Pointer>                       m_items;
+    QQmlModelRowIndex                    m_rowIndex;
+    QQmlModelDataChangeQueue             m_dataChangedQueue;
+    bool                                 m_batchActive;
+    QList<Pointer>                       m_committedItems;
+    QList<Pointer>                       m_batchRemovedItems;
+    QHash<const QObject *, Pointer>      m_batchReplacements;
+    QHash<QString, Pointer>              m_indexByUid;
+    QHash<const QObject *, QString>      m_uidByItem;
+    int                                  m_sortRoleId;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLPOINTERLISTMODEL_H
@@ -5,6 +5,7 @@
 #include <QByteArray>
 #include <QChar>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QList>
 #include <QMetaMethod>
@@ -13,11 +14,16 @@
 #include <QObject>
 #include <QString>
 #include <QStringBuilder>
+#include <QStringList>
 #include <QVariant>
+#include <QSet>
 #include <QVector>
+
 #include <QSharedPointer>
 
 #include "QQmlModelShared.h"
+#include "QQmlModelSnapshot.h"
+#include "QQmlPointerListModel.h"
 
 QQMLMODEL_NAMESPACE_START
 
@@ -34,9 +40,49 @@ class QQmlSharedObjectListModelBase : public QAbstractListModel // abstract Qt b
     Q_PROPERTY (int count READ count NOTIFY countChanged)
     // length can also be used as conveniance
     Q_PROPERTY (int length READ count NOTIFY countChanged)
+    Q_PROPERTY (bool coalesceDataChanged READ coalesceDataChanged WRITE setCoalesceDataChanged NOTIFY coalesceDataChangedChanged)
+    Q_PROPERTY (QString sortRole READ sortRole WRITE setSortRole NOTIFY sortRoleChanged)
+    Q_PROPERTY (Qt::SortOrder sortOrder READ sortOrder WRITE setSortOrder NOTIFY sortOrderChanged)
 
 public:
-    explicit QQmlSharedObjectListModelBase (QObject * parent = Q_NULLPTR) : QAbstractListModel (parent) { }
+    explicit QQmlSharedObjectListModelBase (QObject * parent = Q_NULLPTR) : QAbstractListModel (parent), m_coalesceDataChanged (false), m_batchDepth (0), m_sortOrder (Qt::AscendingOrder), m_deleteBudget (4) { }
+
+    /** When enabled, item property changes are accumulated and notified once per event loop iteration,
+     * as dataChanged on merged contiguous row ranges with the union of their roles. Disabled by default */
+    bool coalesceDataChanged (void) const { return m_coalesceDataChanged; }
+    void setCoalesceDataChanged (bool coalesce) {
+        if (m_coalesceDataChanged != coalesce) {
+            m_coalesceDataChanged = coalesce;
+            if (!coalesce) {
+                flushDataChanged ();
+            }
+            emit coalesceDataChangedChanged ();
+        }
+    }
+    /** When set, the model keeps its items sorted by this role : the items are sorted right away,
+     * inserted items go to their sorted row whatever the requested position, and an item whose
+     * sort role changes is moved to its new row. Empty by default, ie no automatic sorting */
+    const QString & sortRole (void) const { return m_sortRole; }
+    void setSortRole (const QString & role) {
+        if (m_sortRole != role) {
+            m_sortRole = role;
+            updateSortRole ();
+            emit sortRoleChanged ();
+        }
+    }
+    /** Order used when sortRole is set */
+    Qt::SortOrder sortOrder (void) const { return m_sortOrder; }
+    void setSortOrder (Qt::SortOrder order) {
+        if (m_sortOrder != order) {
+            m_sortOrder = order;
+            updateSortRole ();
+            emit sortOrderChanged ();
+        }
+    }
+    /** Time, in milliseconds, spent releasing removed items in each event loop iteration.
+     * Items are released in chunks so that clearing a large model doesn't freeze the UI. 4 by default */
+    int deleteBudget (void) const { return m_deleteBudget; }
+    void setDeleteBudget (int msecs) { m_deleteBudget = qMax (msecs, 1); }
 
 public slots: // virtual methods API for QML
     /** Returns the number of items in the list.
@@ -57,7 +103,8 @@ public slots: // virtual methods API for QML
     virtual int indexOf (QSharedPointer<QObject> item) const = 0;
     /** Get the role id of name, -1 if role not found */
     virtual int roleForName (const QByteArray & name) const = 0;
-    /** Removes all items from the list. It won't delete any object */
+    /** Removes all items from the list, with a single model reset.
+     * The references of the model on the items are released over the next event loop iterations */
     virtual void clear (void) = 0;
     /** Inserts value at the end of the list.
      * This is the same as list.insert(size(), value).
@@ -91,18 +138,57 @@ public slots: // virtual methods API for QML
     /** Removes the item at index position i.
      *i must be a valid index position in the list (i.e., 0 <= i < size()). */
     virtual void remove (int idx) = 0;
+    /** Removes count items starting at index position first, with a single remove notification */
+    virtual void removeRange (int first, int count) = 0;
     virtual QSharedPointer<QObject> get (int idx) const = 0;
     virtual QSharedPointer<QObject> get (const QString & uid) const = 0;
     virtual QSharedPointer<QObject> getFirst (void) const = 0;
     virtual QSharedPointer<QObject> getLast (void) const = 0;
     virtual QVariantList toVarArray (void) const = 0;
+    /** Sort the items by the value of role, items with equal values keep their order.
+     * Delegates are kept : views get a single layoutChanged and persistent indexes follow their item */
+    virtual void sortByRole (const QString & role, Qt::SortOrder order = Qt::AscendingOrder) = 0;
+    /** Sort the items by several roles, each role breaking the ties of the previous one */
+    virtual void sortByRoles (const QStringList & roles, Qt::SortOrder order = Qt::AscendingOrder) = 0;
+    /** Emit the pending coalesced dataChanged right away instead of waiting for the event loop */
+    virtual void flushDataChanged (void) = 0;
+    /** Start recording mutations. Row signals, countChanged and item signals are held
+     * until the matching endBatch(), that emits the minimal set of them for the net change.
+     * Batches can be nested, only the outermost endBatch() commits.
+     * \sa QQmlModelBatch */
+    void beginBatch (void) {
+        if (m_batchDepth++ == 0) {
+            startBatch ();
+        }
+    }
+    /** Commit the mutations recorded since the matching beginBatch() */
+    void endBatch (void) {
+        if (m_batchDepth > 0 && --m_batchDepth == 0) {
+            commitBatch ();
+        }
+    }
+    /** Returns true between beginBatch() and the matching endBatch() */
+    bool isBatching (void) const { return m_batchDepth > 0; }
 
 protected slots: // internal callback
-    virtual void onItemPropertyChanged (void) = 0;
+    virtual void releasePendingItems (void) = 0;
+
+protected: // batch hooks
+    virtual void startBatch (void) = 0;
+    virtual void commitBatch (void) = 0;
+
+protected: // sort hook
+    virtual void updateSortRole (void) = 0;
 
 signals: // notifier
     /** Emitted when count changed (ie removed or inserted item) */
     void countChanged (void);
+    /** Emitted when coalesceDataChanged changed */
+    void coalesceDataChangedChanged (void);
+    /** Emitted when sortRole changed */
+    void sortRoleChanged (void);
+    /** Emitted when sortOrder changed */
+    void sortOrderChanged (void);
 signals:
     /** Emitted when an item is about to be inserted */
     void itemAboutToBeInserted(QSharedPointer<QObject> item, int row);
@@ -116,459 +202,72 @@ signals:
     void itemAboutToBeRemoved(QSharedPointer<QObject> item, int row);
     /** Emitted when an item is about to be removed */
     void itemRemoved(QSharedPointer<QObject> item, int row);
+
+private:
+    bool          m_coalesceDataChanged;
+    int           m_batchDepth;
+    QString       m_sortRole;
+    Qt::SortOrder m_sortOrder;
+    int           m_deleteBudget;
 };
 
-template<class ItemType> class QQmlSharedObjectListModel : public QQmlSharedObjectListModelBase
+template<class ItemType> class QQmlSharedObjectListModel : public QQmlPointerListModel<QSharedPointer<ItemType>, QQmlSharedObjectListModelBase>
 {
+    typedef QQmlPointerListModel<QSharedPointer<ItemType>, QQmlSharedObjectListModelBase> Core;
+    using Core::m_items;
+
 public:
     explicit QQmlSharedObjectListModel (QObject *          parent      = Q_NULLPTR,
-                                  const QList<QByteArray> & exposedRoles = QList<QByteArray>(),
-                                  const QByteArray & displayRole = QByteArray (),
-                                  const QByteArray & uidRole     = QByteArray ())
-        : QQmlSharedObjectListModelBase (parent)
-        , m_count (0)
-        , m_uidRoleName (uidRole)
-        , m_dispRoleName (displayRole)
-        , m_metaObj (ItemType::staticMetaObject)
-    {
-        // Keep a track of black list rolename that are not compatible with Qml, they should never be used
-        static QSet<QByteArray> roleNamesBlacklist;
-        if (roleNamesBlacklist.isEmpty ()) {
-            roleNamesBlacklist << QByteArrayLiteral ("id")
-                               << QByteArrayLiteral ("index")
-                               << QByteArrayLiteral ("class")
-                               << QByteArrayLiteral ("model")
-                               << QByteArrayLiteral ("modelData");
-        }
-
-        // Set handler that handle every property changed
-        static const char * HANDLER = "onItemPropertyChanged()";
-        m_handler = metaObject ()->method (metaObject ()->indexOfMethod (HANDLER));
-
-        // Force a display role the the role map
-        if (!displayRole.isEmpty ()) {
-            m_roles.insert (Qt::DisplayRole, QByteArrayLiteral ("display"));
-        }
-        // Return a pointer to the qtObject as the base Role. This point is essential
-        m_roles.insert (baseRole (), QByteArrayLiteral ("qtObject"));
-
-        // Number of attribute declare with the Q_PROPERTY flags
-        const int len = m_metaObj.propertyCount ();
-        // For every property in the ItemType
-        for (int propertyIdx = 0, role = (baseRole () +1); propertyIdx < len; propertyIdx++, role++) {
-            QMetaProperty metaProp = m_metaObj.property (propertyIdx);
-            const QByteArray propName = QByteArray (metaProp.name ());
-            // Only expose the property as a role if:
-            // - It isn't blacklisted (id, index, class, model, modelData)
-            // - When exposedRoles is empty we expose every property
-            // - When exposedRoles isn't empty we only expose the property asked by the user
-            if (!roleNamesBlacklist.contains (propName) &&
-                (exposedRoles.size() == 0 || exposedRoles.contains(propName)))
-            {
-                m_roles.insert (role, propName);
-                // If there is a notify signal associated with the Q_PROPERTY we keep a track of it for fast lookup
-                if (metaProp.hasNotifySignal ())
-                {
-                    m_signalIdxToRole.insert (metaProp.notifySignalIndex (), role);
-                }
-            }
-            else if(roleNamesBlacklist.contains(propName))
-            {
-                static const QByteArray CLASS_NAME = (QByteArrayLiteral ("QQmlSharedObjectListModel<") % m_metaObj.className () % '>');
-                qWarning () << "Can't have" << propName << "as a role name in" << qPrintable (CLASS_NAME) << ", because it's a blacklisted keywork in QML!. "
-                "Please don't use any of the following words when declaring your Q_PROPERTY: (id, index, class, model, modelData)";
-            }
-        }
-    }
-    bool setData (const QModelIndex & index, const QVariant & value, int role) Q_DECL_FINAL {
-        bool ret = false;
-        QSharedPointer<QObject> item = at (index.row ());
-        const QByteArray rolename = (role != Qt::DisplayRole ? m_roles.value (role, emptyBA ()) : m_dispRoleName);
-        if (item != Q_NULLPTR && role != baseRole () && !rolename.isEmpty ()) {
-            ret = item->setProperty (rolename, value);
-        }
-        return ret;
-    }
-    QVariant data (const QModelIndex & index, int role) const Q_DECL_FINAL {
-        QVariant ret;
-        QSharedPointer<QObject> item = at (index.row ());
-        const QByteArray rolename = (role != Qt::DisplayRole ? m_roles.value (role, emptyBA ()) : m_dispRoleName);
-        if (item != Q_NULLPTR && !rolename.isEmpty ()) {
-            ret.setValue (role != baseRole () ? item->property (rolename) : QVariant::fromValue (item.staticCast<QObject>()));
-        }
-        return ret;
-    }
-    QHash<int, QByteArray> roleNames (void) const Q_DECL_FINAL {
-        return m_roles;
-    }
-    typedef typename QList<QSharedPointer<ItemType>>::const_iterator const_iterator;
-    const_iterator begin (void) const {
-        return m_items.begin ();
-    }
-    const_iterator end (void) const {
-        return m_items.end ();
-    }
-    const_iterator constBegin (void) const {
-        return m_items.constBegin ();
-    }
-    const_iterator constEnd (void) const {
-        return m_items.constEnd ();
-    }
+                                        const QList<QByteArray> & exposedRoles = QList<QByteArray>(),
+                                        const QByteArray & displayRole = QByteArray (),
+                                        const QByteArray & uidRole     = QByteArray ())
+        : Core (parent, exposedRoles, displayRole, uidRole, "QQmlSharedObjectListModel")
+    { }
 
 public: // C++ API
-    QSharedPointer<ItemType> at (int idx) const {
-        QSharedPointer<ItemType> ret = Q_NULLPTR;
-        if (idx >= 0 && idx < m_items.size ()) {
-            ret = m_items.value (idx);
-        }
-        return ret;
-    }
-    QSharedPointer<ItemType> getByUid (const QString & uid) const {
-        return (!m_indexByUid.isEmpty () ? m_indexByUid.value (uid, Q_NULLPTR) : Q_NULLPTR);
-    }
-    int roleForName (const QByteArray & name) const Q_DECL_FINAL {
-        return m_roles.key (name, -1);
-    }
-    int count (void) const Q_DECL_FINAL {
-        return m_count;
-    }
-    int size (void) const Q_DECL_FINAL {
-        return m_count;
-    }
-    bool isEmpty (void) const Q_DECL_FINAL {
-        return m_items.isEmpty ();
-    }
-    bool contains (QSharedPointer<ItemType> item) const {
-        return m_items.contains (item);
-    }
-    int indexOf (QSharedPointer<ItemType> item) const {
-        return m_items.indexOf (item);
-    }
-    void clear (void) Q_DECL_FINAL {
-        if (!m_items.isEmpty ()) {
-            QList<QSharedPointer<ItemType>> tempList;
-            for (int i = 0; i < m_items.count(); ++i)
-                itemAboutToBeRemoved(m_items.at(i), i);
-            beginRemoveRows (noParent (), 0, m_items.count () -1);
-            SHARED_OBJECT_FOREACH_PTR_IN_QLIST (ItemType, item, m_items) {
-                dereferenceItem (item);
-                tempList.append(item);
-            }
-            m_items.clear ();
-            updateCounter ();
-            endRemoveRows ();
-            for (int i = 0; i < tempList.count(); ++i)
-                itemRemoved(tempList.at(i), i);
-        }
-    }
-    void append (QSharedPointer<ItemType> item) {
-        if (item != Q_NULLPTR) {
-            const int pos = m_items.count ();
-            itemAboutToBeInserted(item, pos);
-            beginInsertRows (noParent (), pos, pos);
-            m_items.append (item);
-            referenceItem (item);
-            updateCounter ();
-            endInsertRows ();
-            itemInserted(item, pos);
-        }
-    }
-    void prepend (QSharedPointer<ItemType> item) {
-        if (item != Q_NULLPTR) {
-            itemAboutToBeInserted(item, 0);
-            beginInsertRows (noParent (), 0, 0);
-            m_items.prepend (item);
-            referenceItem (item);
-            updateCounter ();
-            endInsertRows ();
-            itemInserted(item, 0);
-        }
-    }
-    void insert (int idx, QSharedPointer<ItemType> item) {
-        if (item != Q_NULLPTR) {
-            itemAboutToBeInserted(item, idx);
-            beginInsertRows (noParent (), idx, idx);
-            m_items.insert (idx, item);
-            referenceItem (item);
-            updateCounter ();
-            endInsertRows ();
-            itemInserted(item, idx);
-        }
-    }
-    void append (const QList<QSharedPointer<ItemType>> & itemList) {
-        if (!itemList.isEmpty ()) {
-            const int pos = m_items.count ();
-            for(int i = 0; i < itemList.count(); ++i)
-                itemAboutToBeInserted(itemList.at(i), i + pos);
-
-            beginInsertRows (noParent (), pos, pos + itemList.count () -1);
-            m_items.reserve (m_items.count () + itemList.count ());
-            m_items.append (itemList);
-            SHARED_OBJECT_FOREACH_PTR_IN_QLIST (ItemType, item, itemList) {
-                referenceItem (item);
-            }
-            updateCounter ();
-            endInsertRows ();
-            for (int i = 0; i < itemList.count(); ++i)
-                itemInserted(itemList.at(i), i + pos);
-        }
-    }
-    void prepend (const QList<QSharedPointer<ItemType>> & itemList) {
-        if (!itemList.isEmpty ()) {
-            for (int i = 0; i < itemList.count(); ++i)
-                itemAboutToBeInserted(itemList.at(i), i);
-            beginInsertRows (noParent (), 0, itemList.count () -1);
-            m_items.reserve (m_items.count () + itemList.count ());
-            int offset = 0;
-            SHARED_OBJECT_FOREACH_PTR_IN_QLIST (ItemType, item, itemList) {
-                m_items.insert (offset, item);
-                referenceItem (item);
-                offset++;
-            }
-            updateCounter ();
-            endInsertRows ();
-            for (int i = 0; i < itemList.count(); ++i)
-                itemInserted(itemList.at(i), i);
-        }
-    }
-    void insert (int idx, const QList<QSharedPointer<ItemType>> & itemList) {
-        if (!itemList.isEmpty ()) {
-            for (int i = 0; i < itemList.count(); ++i)
-                itemAboutToBeInserted(itemList.at(i), i + idx);
-            beginInsertRows (noParent (), idx, idx + itemList.count () -1);
-            m_items.reserve (m_items.count () + itemList.count ());
-            int offset = 0;
-            SHARED_OBJECT_FOREACH_PTR_IN_QLIST (ItemType, item, itemList) {
-                m_items.insert (idx + offset, item);
-                referenceItem (item);
-                offset++;
-            }
-            updateCounter ();
-            endInsertRows ();
-            for (int i = 0; i < itemList.count(); ++i)
-                itemInserted(itemList.at(i), i + idx);
-        }
-    }
-    void move (int idx, int pos) Q_DECL_FINAL {
-        if (idx != pos && idx >=0 && pos>=0 && idx < m_items.size() && pos < m_items.size()) {
-            itemAboutToBeMoved(m_items.at(idx), idx, pos);
-            beginMoveRows (noParent (), idx, idx, noParent (), (idx < pos ? pos +1 : pos));
-            m_items.move (idx, pos);
-            endMoveRows ();
-            itemMoved(m_items.at(idx), idx, pos);
-        }
-    }
-    void remove (QSharedPointer<ItemType> item) {
-        if (item != Q_NULLPTR) {
-            const int idx = m_items.indexOf (item);
-            remove (idx);
-        }
-    }
-    void remove (int idx) Q_DECL_FINAL {
-        if (idx >= 0 && idx < m_items.size ()) {
-            itemAboutToBeRemoved(m_items.at(idx), idx);
-            beginRemoveRows (noParent (), idx, idx);
-            QSharedPointer<ItemType> item = m_items.takeAt (idx);
-            dereferenceItem (item);
-            updateCounter ();
-            endRemoveRows ();
-            itemRemoved(item, idx);
-        }
-    }
-    QSharedPointer<ItemType> first (void) const {
-        return m_items.first ();
-    }
-    QSharedPointer<ItemType> last (void) const {
-        return m_items.last ();
-    }
-    const QList<QSharedPointer<ItemType>> & toList (void) const {
-        return m_items;
-    }
-
-public: // QML slots implementation
-    void append (QSharedPointer<QObject> item) Q_DECL_FINAL {
-        append (qSharedPointerObjectCast<ItemType>(item));
-    }
-    void prepend (QSharedPointer<QObject> item) Q_DECL_FINAL {
-        prepend (qSharedPointerObjectCast<ItemType>(item));
-    }
-    void insert (int idx, QSharedPointer<QObject> item) Q_DECL_FINAL {
-        insert (idx, qSharedPointerObjectCast<ItemType>(item));
-    }
-    void remove (QSharedPointer<QObject> item) Q_DECL_FINAL {
-        remove (qSharedPointerObjectCast<ItemType>(item));
-    }
-    bool contains (QSharedPointer<QObject> item) const Q_DECL_FINAL {
-        return contains (qSharedPointerObjectCast<ItemType>(item));
-    }
-    int indexOf (QSharedPointer<QObject> item) const Q_DECL_FINAL {
-        return indexOf (qSharedPointerObjectCast<ItemType>(item));
-    }
-    int indexOf (const QString & uid) const {
-        return indexOf (get (uid));
-    }
-    QSharedPointer<QObject> get (int idx) const Q_DECL_FINAL {
-        return qSharedPointerCast<QObject>(at(idx));
-    }
-    QSharedPointer<QObject> get (const QString & uid) const Q_DECL_FINAL {
-        return qSharedPointerCast<QObject>(getByUid(uid));
-    }
-    QSharedPointer<QObject> getFirst (void) const Q_DECL_FINAL {
-        return qSharedPointerCast<QObject>(first());
-    }
-    QSharedPointer<QObject> getLast (void) const Q_DECL_FINAL {
-        return qSharedPointerCast<QObject>(last());
+	/** Immutable view of the items, that other threads can read while the model changes.
+	 * The snapshot keeps its items alive, and is pinned to the thread of the model : the items it
+	 * holds last are deleted there even when a worker drops it. Call it on the thread of the model.
+	 * \sa QQmlModelSnapshot */
+    QQmlModelSnapshot<QSharedPointer<ItemType>> snapshot (void) const {
+        return QQmlModelSnapshot<QSharedPointer<ItemType>>::pinned (m_items);
     }
 
 protected: // internal stuff
-    static const QString & emptyStr (void) {
-        static const QString ret = QStringLiteral ("");
-        return ret;
-    }
-    static const QByteArray & emptyBA (void) {
-        static const QByteArray ret = QByteArrayLiteral ("");
-        return ret;
-    }
-    static const QModelIndex & noParent (void) {
-        static const QModelIndex ret = QModelIndex ();
-        return ret;
-    }
-    static const int & baseRole (void) {
-        static const int ret = Qt::UserRole;
-        return ret;
-    }
-    int rowCount (const QModelIndex & parent = QModelIndex ()) const Q_DECL_FINAL {
-        return (!parent.isValid () ? m_items.count () : 0);
-    }
-    void referenceItem (QSharedPointer<ItemType> item) {
-        if (item != Q_NULLPTR) {
-            if (!item->parent ()) {
-                item->setParent (this);
-            }
-            for (QHash<int, int>::const_iterator it = m_signalIdxToRole.constBegin (); it != m_signalIdxToRole.constEnd (); ++it) {
-                connect(item.get(), item->metaObject()->method(it.key()), this, m_handler, Qt::UniqueConnection);
-            }
-            if (!m_uidRoleName.isEmpty ()) {
-                const QString key = m_indexByUid.key (item, emptyStr ());
-                if (!key.isEmpty ()) {
-                    m_indexByUid.remove (key);
-                }
-                const QString value = item->property (m_uidRoleName).toString ();
-                if (!value.isEmpty ()) {
-                    m_indexByUid.insert (value, item);
-                }
-            }
-        }
-    }
-    void dereferenceItem (QSharedPointer<ItemType> item) {
-        if (item != Q_NULLPTR) {
-            disconnect (this, Q_NULLPTR, item.get(), Q_NULLPTR);
-            disconnect (item.get(), Q_NULLPTR, this, Q_NULLPTR);
-            if (!m_uidRoleName.isEmpty ()) {
-                const QString key = m_indexByUid.key (item, emptyStr ());
-                if (!key.isEmpty ()) {
-                    m_indexByUid.remove (key);
-                }
-            }
-            if (item->parent () == this) { // FIXME : maybe that's not the best way to test ownership ?
-                item->deleteLater ();
-            }
+    /** Queue the reference of the model on item for release by releasePendingItems (), in the next event loop iterations.
+     * The item is disconnected there, along with its release */
+    void releaseItem (const QSharedPointer<ItemType> & item, bool connected) Q_DECL_FINAL {
+        Q_UNUSED (connected);
+        if (m_pendingReleases.isEmpty ()) {
+            QMetaObject::invokeMethod (this, "releasePendingItems", Qt::QueuedConnection);
         }
-    }
-    void onItemPropertyChanged (void) Q_DECL_FINAL {
-        ItemType * _item = qobject_cast<ItemType *> (sender ());
-        QSharedPointer<ItemType> item;
-        for(const auto it: *this)
-        {
-            if(it && it.get() == _item)
-                item = it;
-        }
-        const int row = m_items.indexOf (item);
-        const int sig = senderSignalIndex ();
-        const int role = m_signalIdxToRole.value (sig, -1);
-        if (row >= 0 && role >= 0) {
-            const QModelIndex index = QAbstractListModel::index (row, 0, noParent ());
-            QVector<int> rolesList;
-            rolesList.append (role);
-            if (m_roles.value (role) == m_dispRoleName) {
-                rolesList.append (Qt::DisplayRole);
+        m_pendingReleases.append (item);
+    }
+    /** Release pending items until deleteBudget is spent, and come back in the next iteration for the rest.
+     * Owned items are detached from the model, so the last reference deletes them and the other ones stay valid */
+    void releasePendingItems (void) Q_DECL_FINAL {
+        QElapsedTimer timer;
+        timer.start ();
+        int done = 0;
+        while (done < m_pendingReleases.count ()) {
+            QSharedPointer<ItemType> & item = m_pendingReleases [done++];
+            if (item->parent () == this && !this->contains (item)) { // not inserted back in the meantime
+                QObject::disconnect (item.data (), Q_NULLPTR, this, Q_NULLPTR);
+                item->setParent (Q_NULLPTR);
             }
-            emit dataChanged (index, index, rolesList);
-        }
-        if (!m_uidRoleName.isEmpty ()) {
-            const QByteArray roleName = m_roles.value (role, emptyBA ());
-            if (!roleName.isEmpty () && roleName == m_uidRoleName) {
-                const QString key = m_indexByUid.key (item, emptyStr ());
-                if (!key.isEmpty ()) {
-                    m_indexByUid.remove (key);
-                }
-                const QString value = item->property (m_uidRoleName).toString ();
-                if (!value.isEmpty ()) {
-                    m_indexByUid.insert (value, item);
-                }
+            item.reset ();
+            if ((done % 64) == 0 && timer.elapsed () >= this->deleteBudget ()) {
+                break;
             }
         }
-    }
-    inline void updateCounter (void) {
-        if (m_count != m_items.count ()) {
-            m_count = m_items.count ();
-            emit countChanged ();
-        }
-    }
-
-private:
-    void itemAboutToBeInserted(QSharedPointer<ItemType> item, int row) { onItemAboutToBeInserted(item, row); _onItemAboutToBeInserted(item, row); }
-    void itemInserted(QSharedPointer<ItemType> item, int row) { onItemInserted(item, row); _onItemInserted(item, row); }
-    void itemAboutToBeMoved(QSharedPointer<ItemType> item, int src, int dest) { onItemAboutToBeMoved(item, src, dest); _onItemAboutToBeMoved(item, src, dest); }
-    void itemMoved(QSharedPointer<ItemType> item, int src, int dest) { onItemMoved(item, src, dest); _onItemMoved(item, src, dest); }
-    void itemAboutToBeRemoved(QSharedPointer<ItemType> item, int row) { onItemAboutToBeRemoved(item, row); _onItemAboutToBeRemoved(item, row); }
-    void itemRemoved(QSharedPointer<ItemType> item, int row) { onItemRemoved(item, row); _onItemRemoved(item, row); }
-
-protected:
-    virtual void onItemAboutToBeInserted(QSharedPointer<ItemType> item, int row) { }
-    virtual void onItemInserted(QSharedPointer<ItemType> item, int row) { }
-    virtual void onItemAboutToBeMoved(QSharedPointer<ItemType> item, int src, int dest) { }
-    virtual void onItemMoved(QSharedPointer<ItemType> item, int src, int dest) { }
-    virtual void onItemAboutToBeRemoved(QSharedPointer<ItemType> item, int row) { }
-    virtual void onItemRemoved(QSharedPointer<ItemType> item, int row) { }
-
-private:
-    void _onItemAboutToBeInserted(QSharedPointer<ItemType> item, int row) { emit QQmlSharedObjectListModelBase::itemAboutToBeInserted(item, row); }
-    void _onItemInserted(QSharedPointer<ItemType> item, int row) { emit QQmlSharedObjectListModelBase::itemInserted(item, row); }
-    void _onItemAboutToBeMoved(QSharedPointer<ItemType> item, int src, int dest) { emit QQmlSharedObjectListModelBase::itemAboutToBeMoved(item, src, dest); }
-    void _onItemMoved(QSharedPointer<ItemType> item, int src, int dest) { emit QQmlSharedObjectListModelBase::itemMoved(item, src, dest); }
-    void _onItemAboutToBeRemoved(QSharedPointer<ItemType> item, int row) { emit QQmlSharedObjectListModelBase::itemAboutToBeRemoved(item, row); }
-    void _onItemRemoved(QSharedPointer<ItemType> item, int row) { emit QQmlSharedObjectListModelBase::itemRemoved(item, row); }
-
-    /** Move row to row-1 */
-    void moveUp(const int row) override final
-    {
-        if (row > 0 && row < count())
-            move(row, row - 1);
-    }
-
-    /** Move row to row+1 */
-    void moveDown(const int row) override final
-    {
-        if (count() && // There is a least one entry
-            row >= 0 && // We can be from the first
-            row < (count() - 1) // To the last one minus 1
-            )
-        {
-            return moveUp(row + 1);
+        m_pendingReleases.erase (m_pendingReleases.begin (), m_pendingReleases.begin () + done);
+        if (!m_pendingReleases.isEmpty ()) {
+            QMetaObject::invokeMethod (this, "releasePendingItems", Qt::QueuedConnection);
         }
     }
 
 private: // data members
-    int                        m_count;
-    QByteArray                 m_uidRoleName;
-    QByteArray                 m_dispRoleName;
-    QMetaObject                m_metaObj;
-    QMetaMethod                m_handler;
-    QHash<int, QByteArray>     m_roles;
-    QHash<int, int>            m_signalIdxToRole;
-    QList<QSharedPointer<ItemType>>          m_items;
-    QHash<QString, QSharedPointer<ItemType>> m_indexByUid;
+    QList<QSharedPointer<ItemType>> m_pendingReleases;
 };
 
 #define QQMLMODEL_SHARED_OBJ_PROPERTY(type, name, Name) \
@@ -586,6 +285,17 @@ private: // data members
     public: type * Get##Name (void) const { return _##name; } \
     private:
 
+/**
+ * Same as QQMLMODEL_SHARED_OBJ_PROPERTY, but the model is only created by the first Get##Name() call.
+ * \sa QQMLMODEL_LAZY_OBJ_PROPERTY
+ */
+#define QQMLMODEL_LAZY_SHARED_OBJ_PROPERTY(type, name, Name) \
+    QQMLMODEL_LAZY_SHARED_OBJ_PROPERTY_SUB(QQMLMODEL_NAMESPACE_NAME::QQmlSharedObjectListModel<type>, name, Name)
+
+#define QQMLMODEL_LAZY_SHARED_OBJ_PROPERTY_SUB(type, name, Name) \
+    protected: Q_PROPERTY (QQMLMODEL_NAMESPACE_NAME::QQmlSharedObjectListModelBase * name READ Get##Name CONSTANT) \
+    QQMLMODEL_LAZY_PROPERTY_IMPL(type, name, Name)
+
 /**
  * \internal
  */
@@ -0,0 +1,214 @@
+#ifndef QQMLSTRUCTLISTMODEL_H
+#define QQMLSTRUCTLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QVariant>
+#include <QVariantMap>
+#include <QVector>
+
+#include "QQmlModelShared.h"
+#include "QQmlVectorListModel.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * Role of a QQmlStructListModel : the member of Struct pointed by Member.
+ * Declare roles with QQMLMODEL_STRUCT_ROLE, which adds the name.
+ */
+template<class Struct, class MemberType, MemberType Struct::* Member> struct QQmlStructRole
+{
+    typedef MemberType Type;
+
+    static QVariant read (const Struct & value) {
+        return QVariant::fromValue (value.*Member);
+    }
+    /** Write var in the member, converted to its type. \return Whether the member changed */
+    static bool write (Struct & value, const QVariant & var) {
+        if (!var.canConvert<MemberType> ()) {
+            return false;
+        }
+        const MemberType converted = var.value<MemberType> ();
+        if (value.*Member == converted) {
+            return false;
+        }
+        value.*Member = converted;
+        return true;
+    }
+    static bool equal (const Struct & a, const Struct & b) {
+        return (a.*Member == b.*Member);
+    }
+};
+
+/**
+ * Declare a role named member for Struct::member, inside the struct listing the roles of a model :
+ *
+ * \code
+ * struct Sample { qreal time; qreal value; };
+ * struct SampleRoles {
+ *     QQMLMODEL_STRUCT_ROLE (Sample, time);
+ *     QQMLMODEL_STRUCT_ROLE (Sample, value);
+ * };
+ * typedef QQmlStructListModel<Sample, SampleRoles::time, SampleRoles::value> SampleListModel;
+ * \endcode
+ */
+#define QQMLMODEL_STRUCT_ROLE(Struct, member) \
+    struct member : QQMLMODEL_NAMESPACE_NAME::QQmlStructRole<Struct, decltype (Struct::member), &Struct::member> { \
+        static const char * name (void) { return #member; } \
+    }
+
+/**
+ * \internal
+ * Role dispatch resolved at compile time : role index idx selects the idx-th role of the list.
+ * Each level is inlined in the next one, so the compiler reduces a lookup to a chain of
+ * comparisons or a jump table on idx, without any QMetaProperty or QVariant dispatch.
+ */
+template<class Struct, class ... Roles> struct QQmlStructRoleDispatch;
+
+template<class Struct> struct QQmlStructRoleDispatch<Struct>
+{
+    static void names (QHash<int, QByteArray> &, int) { }
+    static QVariant read (const Struct &, int) { return QVariant (); }
+    static bool write (Struct &, int, const QVariant &) { return false; }
+    static void changed (const Struct &, const Struct &, int, QVector<int> &) { }
+};
+
+template<class Struct, class Role, class ... Others> struct QQmlStructRoleDispatch<Struct, Role, Others...>
+{
+    typedef QQmlStructRoleDispatch<Struct, Others...> Next;
+
+    static void names (QHash<int, QByteArray> & ret, int role) {
+        ret.insert (role, QByteArray (Role::name ()));
+        Next::names (ret, role +1);
+    }
+    static QVariant read (const Struct & value, int idx) {
+        return (idx == 0 ? Role::read (value) : Next::read (value, idx -1));
+    }
+    static bool write (Struct & value, int idx, const QVariant & var) {
+        return (idx == 0 ? Role::write (value, var) : Next::write (value, idx -1, var));
+    }
+    /** Append to ret the role of every member that differs between a and b, first being the role of Role */
+    static void changed (const Struct & a, const Struct & b, int first, QVector<int> & ret) {
+        if (!Role::equal (a, b)) {
+            ret.append (first);
+        }
+        Next::changed (a, b, first +1, ret);
+    }
+};
+
+class QQmlStructListModelBase : public QAbstractListModel { // abstract Qt base class
+    Q_OBJECT
+    Q_PROPERTY (int count READ count NOTIFY countChanged)
+    Q_PROPERTY (int length READ count NOTIFY countChanged)
+
+public:
+    explicit QQmlStructListModelBase (QObject * parent = Q_NULLPTR) : QAbstractListModel (parent) { }
+
+public slots: // virtual methods API for QML
+	/** Returns the number of values in the list */
+	virtual int count (void) const = 0;
+	/** Returns true if the list contains no value; otherwise returns false */
+	virtual bool isEmpty (void) const = 0;
+	/** Removes all values from the list, with a single model reset */
+	virtual void clear (void) = 0;
+	/** Moves the value at index position idx to index position pos */
+	virtual void move (int idx, int pos) = 0;
+	/** Removes the value at index position idx */
+	virtual void remove (int idx) = 0;
+	/** Removes count values starting at index position first, with a single remove notification */
+	virtual void removeRange (int first, int count) = 0;
+	/** Returns the roles of the value at idx by name, empty if idx is out of range */
+	virtual QVariantMap get (int idx) const = 0;
+
+signals: // notifier
+	/** Emitted when count changed (ie removed or inserted values) */
+    void countChanged (void);
+};
+
+/**
+ * List model of plain structs, with roles resolved at compile time.
+ *
+ * Struct needs no Q_GADGET nor moc : the roles are the members listed in
+ * Roles, declared with QQMLMODEL_STRUCT_ROLE, and numbered in this order from
+ * Qt::UserRole + 1. roleNames(), data() and setData() dispatch on the role
+ * index through QQmlStructRoleDispatch, so hot numeric lists skip the meta
+ * object system entirely. Member types need operator== and must be storable
+ * in a QVariant.
+ *
+ * Values are stored contiguously in a QVector<Struct>. The API is the QList
+ * like API of QQmlVectorListModel, plus set() that notifies only the members
+ * that changed.
+ */
+template<class Struct, class ... Roles> class QQmlStructListModel : public QQmlVectorListModel<Struct, QQmlStructListModelBase>
+{
+    Q_STATIC_ASSERT_X (sizeof... (Roles) > 0, "QQmlStructListModel needs at least one role");
+
+    typedef QQmlStructRoleDispatch<Struct, Roles...> Dispatch;
+    typedef QQmlVectorListModel<Struct, QQmlStructListModelBase> Storage;
+    using Storage::m_items;
+
+public:
+    explicit QQmlStructListModel (QObject * parent = Q_NULLPTR)
+        : Storage (parent)
+    { }
+    bool setData (const QModelIndex & index, const QVariant & value, int role) Q_DECL_FINAL {
+        const int row = index.row ();
+        if (row < 0 || row >= m_items.count () || !Dispatch::write (m_items [row], role - firstRole (), value)) {
+            return false;
+        }
+        emit this->dataChanged (index, index, QVector<int> () << role);
+        return true;
+    }
+    QVariant data (const QModelIndex & index, int role) const Q_DECL_FINAL {
+        const int row = index.row ();
+        return (row >= 0 && row < m_items.count () ? Dispatch::read (m_items.at (row), role - firstRole ()) : QVariant ());
+    }
+    QHash<int, QByteArray> roleNames (void) const Q_DECL_FINAL {
+        static const QHash<int, QByteArray> ret = buildRoleNames ();
+        return ret;
+    }
+
+public: // C++ API
+    /** Role of the first member listed in Roles, the next ones follow */
+    static int firstRole (void) {
+        return (Qt::UserRole +1);
+    }
+	QVariantMap get (int idx) const Q_DECL_FINAL {
+        QVariantMap ret;
+        if (idx >= 0 && idx < m_items.count ()) {
+            const QHash<int, QByteArray> roles = roleNames ();
+            for (QHash<int, QByteArray>::const_iterator it = roles.constBegin (); it != roles.constEnd (); ++it) {
+                ret.insert (QString::fromLatin1 (it.value ()), Dispatch::read (m_items.at (idx), it.key () - firstRole ()));
+            }
+        }
+        return ret;
+    }
+	/** Replace the value at idx, and notify the roles of the members that changed.
+	 * \return Whether a member changed */
+	bool set (int idx, const Struct & value) {
+        if (idx < 0 || idx >= m_items.count ()) {
+            return false;
+        }
+        QVector<int> roles;
+        Dispatch::changed (m_items.at (idx), value, firstRole (), roles);
+        if (!roles.isEmpty ()) {
+            m_items [idx] = value;
+            const QModelIndex index = this->QAbstractListModel::index (idx, 0, Storage::noParent ());
+            emit this->dataChanged (index, index, roles);
+        }
+        return !roles.isEmpty ();
+    }
+
+protected: // internal stuff
+    static QHash<int, QByteArray> buildRoleNames (void) {
+        QHash<int, QByteArray> ret;
+        Dispatch::names (ret, firstRole ());
+        return ret;
+    }
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLSTRUCTLISTMODEL_H
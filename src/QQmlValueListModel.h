@@ -0,0 +1,404 @@
+#ifndef QQMLVALUELISTMODEL_H
+#define QQMLVALUELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QVariant>
+#include <QVector>
+
+#include <algorithm>
+#include <utility>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+class QQmlValueListModelBase : public QAbstractListModel { // abstract Qt base class
+    Q_OBJECT
+    Q_PROPERTY (int count READ count NOTIFY countChanged)
+
+public:
+    explicit QQmlValueListModelBase (QObject * parent = Q_NULLPTR) : QAbstractListModel (parent), m_batchDepth (0) { }
+
+	/** Role holding the value, named 'qtVariant' like in QQmlVariantListModel */
+    static int baseRole (void) { return Qt::UserRole; }
+
+public slots: // virtual methods API for QML, values are converted to the value type of the model
+	virtual void clear (void) = 0;
+	virtual int count (void) const = 0;
+	virtual bool isEmpty (void) const = 0;
+	virtual void append (const QVariant & item) = 0;
+	virtual void prepend (const QVariant & item) = 0;
+	virtual void insert (int idx, const QVariant & item) = 0;
+	virtual void appendList (const QVariantList & itemList) = 0;
+	virtual void prependList (const QVariantList & itemList) = 0;
+	virtual void replace (int pos, const QVariant & item) = 0;
+	virtual void insertList (int idx, const QVariantList & itemList) = 0;
+	virtual void move (int idx, int pos) = 0;
+	virtual void remove (int idx) = 0;
+	virtual void removeRange (int first, int count) = 0;
+	virtual QVariantList takeRange (int first, int count) = 0;
+	virtual QVariant get (int idx) const = 0;
+	virtual QVariantList list (void) const = 0;
+	/** Start recording mutations, views keep seeing the list as it was until the matching endBatch().
+	 * Batches can be nested, only the outermost endBatch() commits */
+	void beginBatch (void) {
+        if (m_batchDepth++ == 0) {
+            startBatch ();
+        }
+    }
+	/** Commit the mutations recorded since the matching beginBatch(), like QQmlVariantListModel does */
+	void endBatch (void) {
+        if (m_batchDepth > 0 && --m_batchDepth == 0) {
+            commitBatch ();
+        }
+    }
+	/** Returns true between beginBatch() and the matching endBatch() */
+	bool isBatching (void) const { return m_batchDepth > 0; }
+
+protected: // batch hooks
+    virtual void startBatch (void) = 0;
+    virtual void commitBatch (void) = 0;
+
+signals: // notifiers
+    void countChanged (int count);
+
+private:
+    int m_batchDepth;
+};
+
+/**
+ * List model of values of type T, stored contiguously in a QVector<T>.
+ *
+ * The API is the one of QQmlVariantListModel, but values aren't boxed in
+ * QVariant : they are converted only at the data() boundary and by the QML
+ * slots, and C++ callers use the typed overloads and bulk accessors. T needs
+ * operator==, used to compute the net change of a batch, and must be
+ * storable in a QVariant. QQmlVariantListModel remains the model of QVariant.
+ */
+template<class T> class QQmlValueListModel : public QQmlValueListModelBase
+{
+public:
+    explicit QQmlValueListModel (QObject * parent = Q_NULLPTR)
+        : QQmlValueListModelBase (parent)
+        , m_count (0)
+        , m_batchActive (false)
+    { }
+
+public: // QAbstractItemModel interface reimplemented
+    int rowCount (const QModelIndex & parent = QModelIndex ()) const Q_DECL_FINAL {
+        return (!parent.isValid () ? visibleItems ().count () : 0);
+    }
+    bool setData (const QModelIndex & index, const QVariant & value, int role) Q_DECL_FINAL {
+        const int idx = index.row ();
+        if (idx < 0 || idx >= m_items.count () || role != baseRole () || !value.canConvert<T> ()) {
+            return false;
+        }
+        replace (idx, value.value<T> ());
+        return true;
+    }
+    QVariant data (const QModelIndex & index, int role) const Q_DECL_FINAL {
+        const QVector<T> & items = visibleItems ();
+        const int idx = index.row ();
+        return (idx >= 0 && idx < items.count () && role == baseRole () ? QVariant::fromValue (items.at (idx)) : QVariant ());
+    }
+    QHash<int, QByteArray> roleNames (void) const Q_DECL_FINAL {
+        static QHash<int, QByteArray> ret;
+        if (ret.isEmpty ()) {
+            ret.insert (baseRole (), QByteArrayLiteral ("qtVariant"));
+        }
+        return ret;
+    }
+
+public: // QML API
+    void clear (void) Q_DECL_FINAL {
+        if (!m_items.isEmpty ()) {
+            beginRemove (0, m_items.count () -1);
+            m_items.clear ();
+            endRemove ();
+            updateCounter ();
+        }
+    }
+    int count (void) const Q_DECL_FINAL {
+        return visibleItems ().count ();
+    }
+    bool isEmpty (void) const Q_DECL_FINAL {
+        return visibleItems ().isEmpty ();
+    }
+    void append (const QVariant & item) Q_DECL_FINAL {
+        append (item.value<T> ());
+    }
+    void prepend (const QVariant & item) Q_DECL_FINAL {
+        prepend (item.value<T> ());
+    }
+    void insert (int idx, const QVariant & item) Q_DECL_FINAL {
+        insert (idx, item.value<T> ());
+    }
+    void appendList (const QVariantList & itemList) Q_DECL_FINAL {
+        insertItems (m_items.count (), fromVariants (itemList), true);
+    }
+    void prependList (const QVariantList & itemList) Q_DECL_FINAL {
+        insertItems (0, fromVariants (itemList), true);
+    }
+    void replace (int pos, const QVariant & item) Q_DECL_FINAL {
+        replace (pos, item.value<T> ());
+    }
+    void insertList (int idx, const QVariantList & itemList) Q_DECL_FINAL {
+        insertItems (idx, fromVariants (itemList), true);
+    }
+    void move (int idx, int pos) Q_DECL_FINAL {
+        if (idx != pos && idx >= 0 && pos >= 0 && idx < m_items.count () && pos < m_items.count ()) {
+            beginMove (idx, (idx < pos ? pos +1 : pos));
+            typename QVector<T>::iterator first = m_items.begin ();
+            if (idx < pos) {
+                std::rotate (first + idx, first + idx +1, first + pos +1);
+            }
+            else {
+                std::rotate (first + pos, first + idx, first + idx +1);
+            }
+            endMove ();
+        }
+    }
+    void remove (int idx) Q_DECL_FINAL {
+        removeRange (idx, 1);
+    }
+    void removeRange (int first, int count) Q_DECL_FINAL {
+        takeValues (first, count);
+    }
+    QVariantList takeRange (int first, int count) Q_DECL_FINAL {
+        return toVariants (takeValues (first, count));
+    }
+    QVariant get (int idx) const Q_DECL_FINAL {
+        return (idx >= 0 && idx < m_items.count () ? QVariant::fromValue (m_items.at (idx)) : QVariant ());
+    }
+    QVariantList list (void) const Q_DECL_FINAL {
+        return toVariants (m_items);
+    }
+
+public: // C++ API
+	/** Value at idx, idx must be valid */
+	const T & at (int idx) const {
+        return m_items.at (idx);
+    }
+	/** The values, without any conversion */
+	const QVector<T> & values (void) const {
+        return m_items;
+    }
+	/** Count of the values including the changes of the running batch, same as count () outside of a batch */
+	int pendingCount (void) const {
+        return m_items.count ();
+    }
+	void append (const T & item) {
+        insert (m_items.count (), item);
+    }
+	void prepend (const T & item) {
+        insert (0, item);
+    }
+	void insert (int idx, const T & item) {
+        idx = qBound (0, idx, m_items.count ());
+        beginInsert (idx, idx);
+        m_items.insert (idx, item);
+        endInsert ();
+        updateCounter ();
+    }
+	void replace (int pos, const T & item) {
+        if (pos >= 0 && pos < m_items.count ()) {
+            m_items [pos] = item;
+            notifyChanged (pos, pos);
+        }
+    }
+	void appendList (const QVector<T> & itemList) {
+        insertItems (m_items.count (), itemList, false);
+    }
+	void prependList (const QVector<T> & itemList) {
+        insertItems (0, itemList, false);
+    }
+	void insertList (int idx, const QVector<T> & itemList) {
+        insertItems (idx, itemList, false);
+    }
+	/** Same as appendList (itemList), the storage of itemList becomes the model storage when the model is empty */
+	void appendList (QVector<T> && itemList) {
+        insertItems (m_items.count (), std::move (itemList), true);
+    }
+	void prependList (QVector<T> && itemList) {
+        insertItems (0, std::move (itemList), true);
+    }
+	void insertList (int idx, QVector<T> && itemList) {
+        insertItems (idx, std::move (itemList), true);
+    }
+	/** Replace every value, as one remove and one insert, or the net change when batching */
+	void setValues (const QVector<T> & itemList) {
+        beginBatch ();
+        m_items = itemList;
+        endBatch ();
+    }
+	/** Removes count values starting at first, with a single remove notification, and returns them */
+	QVector<T> takeValues (int first, int count) {
+        QVector<T> ret;
+        if (first >= 0 && count > 0 && first < m_items.count ()) {
+            const int last = (qMin (first + count, m_items.count ()) -1);
+            ret = m_items.mid (first, last - first +1);
+            beginRemove (first, last);
+            m_items.remove (first, last - first +1);
+            endRemove ();
+            updateCounter ();
+        }
+        return ret;
+    }
+	/** Removes every value for which predicate (value) returns true, and returns how many were removed.
+	 * The storage is compacted in a single pass, views get the net change as a batch would */
+	template<class Predicate> int removeIf (Predicate predicate) {
+        QVector<T> kept;
+        kept.reserve (m_items.count ());
+        for (typename QVector<T>::const_iterator it = m_items.constBegin (); it != m_items.constEnd (); ++it) {
+            if (!predicate (* it)) {
+                kept.append (* it);
+            }
+        }
+        const int ret = (m_items.count () - kept.count ());
+        if (ret > 0) {
+            beginBatch ();
+            m_items.swap (kept);
+            endBatch ();
+        }
+        return ret;
+    }
+
+protected: // internal stuff
+    static const QModelIndex & noParent (void) {
+        static const QModelIndex ret = QModelIndex ();
+        return ret;
+    }
+    static QVector<T> fromVariants (const QVariantList & itemList) {
+        QVector<T> ret;
+        ret.reserve (itemList.count ());
+        for (QVariantList::const_iterator it = itemList.constBegin (); it != itemList.constEnd (); ++it) {
+            ret.append ((* it).value<T> ());
+        }
+        return ret;
+    }
+    static QVariantList toVariants (const QVector<T> & itemList) {
+        QVariantList ret;
+        ret.reserve (itemList.count ());
+        for (typename QVector<T>::const_iterator it = itemList.constBegin (); it != itemList.constEnd (); ++it) {
+            ret.append (QVariant::fromValue (* it));
+        }
+        return ret;
+    }
+    /** The list views know about, it only differs from the values during a batch */
+    const QVector<T> & visibleItems (void) const {
+        return (m_batchActive ? m_committedItems : m_items);
+    }
+    /** When adopt is true, itemList isn't shared and its buffer can become the model storage */
+    void insertItems (int idx, QVector<T> itemList, bool adopt) {
+        if (itemList.isEmpty ()) {
+            return;
+        }
+        idx = qBound (0, idx, m_items.count ());
+        beginInsert (idx, idx + itemList.count () -1);
+        if (adopt && m_items.isEmpty ()) {
+            m_items.swap (itemList);
+        }
+        else if (idx == m_items.count ()) {
+            m_items += itemList;
+        }
+        else {
+            m_items.insert (idx, itemList.count (), T ());
+            std::copy (itemList.constBegin (), itemList.constEnd (), m_items.begin () + idx);
+        }
+        endInsert ();
+        updateCounter ();
+    }
+    void startBatch (void) Q_DECL_FINAL {
+        m_committedItems = m_items;
+        m_batchActive = true;
+    }
+    /** Same net change as QQmlVariantListModel : common head and tail are kept, the middle is
+     * notified as one dataChanged plus one remove or one insert for the size difference */
+    void commitBatch (void) Q_DECL_FINAL {
+        const int oldCount = m_committedItems.count ();
+        const int newCount = m_items.count ();
+        int head = 0;
+        while (head < oldCount && head < newCount && m_committedItems.at (head) == m_items.at (head)) {
+            ++head;
+        }
+        int tail = 0;
+        while (tail < oldCount - head && tail < newCount - head &&
+               m_committedItems.at (oldCount - tail -1) == m_items.at (newCount - tail -1)) {
+            ++tail;
+        }
+        const int oldMiddle = (oldCount - head - tail);
+        const int newMiddle = (newCount - head - tail);
+        if (oldMiddle > newMiddle) {
+            beginRemoveRows (noParent (), head + newMiddle, head + oldMiddle -1);
+            m_committedItems.remove (head + newMiddle, oldMiddle - newMiddle);
+            endRemoveRows ();
+        }
+        else if (newMiddle > oldMiddle) {
+            beginInsertRows (noParent (), head + oldMiddle, head + newMiddle -1);
+            m_committedItems = m_items;
+            endInsertRows ();
+        }
+        m_committedItems.clear ();
+        m_batchActive = false;
+        const int changed = qMin (oldMiddle, newMiddle);
+        if (changed > 0) {
+            notifyChanged (head, head + changed -1);
+        }
+        updateCounter ();
+    }
+    void beginInsert (int first, int last) {
+        if (!isBatching ()) {
+            beginInsertRows (noParent (), first, last);
+        }
+    }
+    void endInsert (void) {
+        if (!isBatching ()) {
+            endInsertRows ();
+        }
+    }
+    void beginRemove (int first, int last) {
+        if (!isBatching ()) {
+            beginRemoveRows (noParent (), first, last);
+        }
+    }
+    void endRemove (void) {
+        if (!isBatching ()) {
+            endRemoveRows ();
+        }
+    }
+    /** destChild is the row before which idx goes, in the rows as they are before the move */
+    void beginMove (int idx, int destChild) {
+        if (!isBatching ()) {
+            beginMoveRows (noParent (), idx, idx, noParent (), destChild);
+        }
+    }
+    void endMove (void) {
+        if (!isBatching ()) {
+            endMoveRows ();
+        }
+    }
+    void notifyChanged (int first, int last) {
+        if (!isBatching ()) {
+            emit dataChanged (QAbstractListModel::index (first, 0, noParent ()), QAbstractListModel::index (last, 0, noParent ()), QVector<int> (1, baseRole ()));
+        }
+    }
+    void updateCounter (void) {
+        if (!isBatching () && m_count != m_items.count ()) {
+            m_count = m_items.count ();
+            emit countChanged (m_count);
+        }
+    }
+
+private: // data members
+    int        m_count;
+    bool       m_batchActive;
+    QVector<T> m_items;
+    QVector<T> m_committedItems;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLVALUELISTMODEL_H
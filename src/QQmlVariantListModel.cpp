@@ -1,4 +1,7 @@
 
+#include <utility>
+
+#include "QQmlModelArchive.h"
 #include "QQmlVariantListModel.h"
 
 QQMLMODEL_USING_NAMESPACE;
@@ -44,6 +47,8 @@ QQMLMODEL_USING_NAMESPACE;
 */
 QQmlVariantListModel::QQmlVariantListModel (QObject * parent) : QAbstractListModel (parent)
   , m_count(0)
+  , m_batchDepth(0)
+  , m_batchActive(false)
   , m_items()
   , m_roles()
 {
@@ -63,7 +68,7 @@ QQmlVariantListModel::~QQmlVariantListModel (void) {
 int QQmlVariantListModel::rowCount (const QModelIndex & parent) const
 {
     Q_UNUSED (parent);
-    return m_items.count ();
+    return visibleItems ().count ();
 }
 
 /*!
@@ -80,9 +85,10 @@ int QQmlVariantListModel::rowCount (const QModelIndex & parent) const
 QVariant QQmlVariantListModel::data (const QModelIndex & index, int role) const
 {
     QVariant ret;
+    const QVariantList & items = visibleItems ();
     int idx = index.row ();
-    if (idx >= 0 && idx < count () && role == BASE_ROLE) {
-        ret = m_items.value (idx);
+    if (idx >= 0 && idx < items.count () && role == BASE_ROLE) {
+        ret = items.value (idx);
     }
     return ret;
 }
@@ -117,10 +123,9 @@ bool QQmlVariantListModel::setData (const QModelIndex & index, const QVariant &
 {
     bool ret = false;
     int idx = index.row ();
-    if (idx >= 0 && idx < count () && role == BASE_ROLE) {
+    if (idx >= 0 && idx < m_items.count () && role == BASE_ROLE) {
         m_items.replace (idx, value);
-        QModelIndex item = QAbstractListModel::index (idx, 0, NO_PARENT);
-        emit dataChanged (item, item, QVector<int> (1, role));
+        notifyChanged (idx, idx);
         ret = true;
     }
     return ret;
@@ -129,21 +134,31 @@ bool QQmlVariantListModel::setData (const QModelIndex & index, const QVariant &
 /*!
     \details Counts the items in the model.
 
-    \return The count of items in the model
+    \return The count of items the view knows, which doesn't change until a batch is committed
 */
 int QQmlVariantListModel::count () const
 {
-    return m_items.size ();
+    return visibleItems ().size ();
 }
 
 /*!
     \details Tests the content of the model.
 
-    \return Whether the model contains no item
+    \return Whether the model contains no item, as the view knows it
 */
 bool QQmlVariantListModel::isEmpty () const
 {
-    return m_items.isEmpty ();
+    return visibleItems ().isEmpty ();
+}
+
+/*!
+    \details Counts the items in the model including the changes of the running batch.
+
+    \return The count of items in the model, same as count () outside of a batch
+*/
+int QQmlVariantListModel::pendingCount () const
+{
+    return m_items.size ();
 }
 
 /*!
@@ -152,9 +167,9 @@ bool QQmlVariantListModel::isEmpty () const
 void QQmlVariantListModel::clear ()
 {
     if (!m_items.isEmpty ()) {
-        beginRemoveRows (NO_PARENT, 0, count () -1);
+        beginRemove (0, m_items.count () -1);
         m_items.clear ();
-        endRemoveRows ();
+        endRemove ();
         updateCounter ();
     }
 }
@@ -169,9 +184,9 @@ void QQmlVariantListModel::clear ()
 void QQmlVariantListModel::append (const QVariant & item)
 {
     int pos = m_items.count ();
-    beginInsertRows (NO_PARENT, pos, pos);
+    beginInsert (pos, pos);
     m_items.append (item);
-    endInsertRows ();
+    endInsert ();
     updateCounter ();
 }
 
@@ -184,9 +199,9 @@ void QQmlVariantListModel::append (const QVariant & item)
 */
 void QQmlVariantListModel::prepend (const QVariant & item)
 {
-    beginInsertRows (NO_PARENT, 0, 0);
+    beginInsert (0, 0);
     m_items.prepend (item);
-    endInsertRows ();
+    endInsert ();
     updateCounter ();
 }
 
@@ -200,9 +215,9 @@ void QQmlVariantListModel::prepend (const QVariant & item)
 */
 void QQmlVariantListModel::insert (int idx, const QVariant & item)
 {
-    beginInsertRows (NO_PARENT, idx, idx);
+    beginInsert (idx, idx);
     m_items.insert (idx, item);
-    endInsertRows ();
+    endInsert ();
     updateCounter ();
 }
 
@@ -216,10 +231,9 @@ void QQmlVariantListModel::insert (int idx, const QVariant & item)
 */
 void QQmlVariantListModel::replace (int pos, const QVariant & item)
 {
-    if (pos >= 0 && pos < count ()) {
+    if (pos >= 0 && pos < m_items.count ()) {
         m_items.replace (pos, item);
-        QModelIndex index = QAbstractListModel::index (pos, 0, NO_PARENT);
-        emit dataChanged (index, index, QVector<int> (1, BASE_ROLE));
+        notifyChanged (pos, pos);
     }
 }
 
@@ -234,9 +248,9 @@ void QQmlVariantListModel::appendList (const QVariantList & itemList)
 {
     if (!itemList.isEmpty ()) {
         int pos = m_items.count ();
-        beginInsertRows (NO_PARENT, pos, pos + itemList.count () -1);
+        beginInsert (pos, pos + itemList.count () -1);
         m_items.append (itemList);
-        endInsertRows ();
+        endInsert ();
         updateCounter ();
     }
 }
@@ -250,15 +264,7 @@ void QQmlVariantListModel::appendList (const QVariantList & itemList)
 */
 void QQmlVariantListModel::prependList (const QVariantList & itemList)
 {
-    if (!itemList.isEmpty ()) {
-        beginInsertRows (NO_PARENT, 0, itemList.count () -1);
-        int offset = 0;
-        foreach (QVariant item, itemList) {
-            m_items.insert (offset, item);
-        }
-        endInsertRows ();
-        updateCounter ();
-    }
+    insertItems (0, itemList, false);
 }
 
 /*!
@@ -271,16 +277,123 @@ void QQmlVariantListModel::prependList (const QVariantList & itemList)
 */
 void QQmlVariantListModel::insertList (int idx, const QVariantList & itemList)
 {
-    if (!itemList.isEmpty ()) {
-        beginInsertRows (NO_PARENT, idx, idx + itemList.count () -1);
-        int offset = 0;
-        foreach (QVariant item, itemList) {
-            m_items.insert (idx + offset, item);
-            offset++;
+    insertItems (idx, itemList, false);
+}
+
+/*!
+    \details Adds the given list of items at the end of the model, without copying them.
+
+    When the model is empty, the storage of \a itemList becomes the model storage.
+
+    \param itemList The list of items
+*/
+void QQmlVariantListModel::appendList (QVariantList && itemList)
+{
+    insertItems (m_items.count (), std::move (itemList), true);
+}
+
+/*!
+    \details Adds the given list of items at the beginning of the model, without copying them.
+
+    The current items are appended to the storage of \a itemList, that becomes the model storage.
+
+    \param itemList The list of items
+*/
+void QQmlVariantListModel::prependList (QVariantList && itemList)
+{
+    insertItems (0, std::move (itemList), true);
+}
+
+/*!
+    \details Adds the given list of items at a certain position in the model, without copying them.
+
+    \param idx The position where the items must be added
+    \param itemList The list of items
+*/
+void QQmlVariantListModel::insertList (int idx, QVariantList && itemList)
+{
+    insertItems (idx, std::move (itemList), true);
+}
+
+/*!
+    \internal
+    \details Splices \a itemList at \a idx, building the new storage in a single pass.
+
+    When \a adopt is true, \a itemList isn't shared and its buffer can become the model storage.
+*/
+void QQmlVariantListModel::insertItems (int idx, QVariantList itemList, bool adopt)
+{
+    if (itemList.isEmpty ()) {
+        return;
+    }
+    idx = qBound (0, idx, m_items.count ());
+    beginInsert (idx, idx + itemList.count () -1);
+    if (idx == m_items.count ()) {
+        if (adopt && m_items.isEmpty ()) {
+            m_items.swap (itemList);
         }
-        endInsertRows ();
-        updateCounter ();
+        else {
+            m_items.append (itemList);
+        }
+    }
+    else if (adopt && idx == 0) {
+        itemList.append (m_items);
+        m_items.swap (itemList);
+    }
+    else {
+        QVariantList spliced;
+        spliced.reserve (m_items.count () + itemList.count ());
+        for (int row = 0; row < idx; ++row) {
+            spliced.append (m_items.at (row));
+        }
+        spliced.append (itemList);
+        for (int row = idx; row < m_items.count (); ++row) {
+            spliced.append (m_items.at (row));
+        }
+        m_items.swap (spliced);
+    }
+    endInsert ();
+    updateCounter ();
+}
+
+/*!
+    \internal
+    \details Removes the items whose flag is set, compacting the storage in a single pass.
+
+    Views are then notified with one remove per contiguous run of flagged rows, last run first so
+    the rows of the remaining runs stay valid.
+*/
+void QQmlVariantListModel::removeFlagged (const QVector<bool> & flags)
+{
+    QVariantList kept;
+    kept.reserve (m_items.count ());
+    for (int row = 0; row < m_items.count (); ++row) {
+        if (!flags.at (row)) {
+            kept.append (m_items.at (row));
+        }
+    }
+    if (isBatching ()) {
+        m_items.swap (kept);
+        return;
     }
+    // Views keep seeing the old list while the runs are removed from it one by one
+    m_committedItems.swap (m_items);
+    m_items.swap (kept);
+    m_batchActive = true;
+    for (int row = flags.size () -1; row >= 0; --row) {
+        if (flags.at (row)) {
+            const int last = row;
+            while (row > 0 && flags.at (row -1)) {
+                --row;
+            }
+            beginRemoveRows (NO_PARENT, row, last);
+            m_committedItems.erase (m_committedItems.begin () + row, m_committedItems.begin () + last +1);
+            endRemoveRows ();
+        }
+    }
+    m_committedItems.clear ();
+    m_batchActive = false;
+    updateCounter ();
 }
 
 /*!
@@ -294,11 +407,11 @@ void QQmlVariantListModel::move (int idx, int pos)
     if (idx != pos) {
         // FIXME : use begin/end MoveRows when supported by Repeater, since then use remove/insert pair
         //beginMoveRows (NO_PARENT, idx, idx, NO_PARENT, (idx < pos ? pos +1 : pos));
-        beginRemoveRows (NO_PARENT, idx, idx);
-        beginInsertRows (NO_PARENT, pos, pos);
+        beginRemove (idx, idx);
+        beginInsert (pos, pos);
         m_items.move (idx, pos);
-        endRemoveRows ();
-        endInsertRows ();
+        endRemove ();
+        endInsert ();
         //endMoveRows ();
     }
 }
@@ -311,13 +424,45 @@ void QQmlVariantListModel::move (int idx, int pos)
 void QQmlVariantListModel::remove (int idx)
 {
     if (idx >= 0 && idx < m_items.size ()) {
-        beginRemoveRows (NO_PARENT, idx, idx);
+        beginRemove (idx, idx);
         m_items.removeAt (idx);
-        endRemoveRows ();
+        endRemove ();
         updateCounter ();
     }
 }
 
+/*!
+    \details Remove a range of items from the model, with a single remove notification.
+
+    \param first The position of the first item to remove
+    \param count The number of items to remove, clamped to the end of the model
+*/
+void QQmlVariantListModel::removeRange (int first, int count)
+{
+    takeRange (first, count);
+}
+
+/*!
+    \details Remove a range of items from the model and return them.
+
+    \param first The position of the first item to remove
+    \param count The number of items to remove, clamped to the end of the model
+    \return The removed items
+*/
+QVariantList QQmlVariantListModel::takeRange (int first, int count)
+{
+    QVariantList ret;
+    if (first >= 0 && count > 0 && first < m_items.size ()) {
+        const int last = (qMin (first + count, m_items.size ()) -1);
+        ret = m_items.mid (first, last - first +1);
+        beginRemove (first, last);
+        m_items.erase (m_items.begin () + first, m_items.begin () + last +1);
+        endRemove ();
+        updateCounter ();
+    }
+    return ret;
+}
+
 /*!
     \details Retreives a model item as a standard Qt variant object.
 
@@ -343,13 +488,239 @@ QVariantList QQmlVariantListModel::list () const
     return m_items;
 }
 
+/*!
+    \details Retreives an immutable view of the items, sharing the model storage until the model changes.
+
+    The snapshot can be read from any thread while the model keeps changing, but must be taken on the thread of the model.
+
+    \return A \c QQmlModelSnapshot of the items
+*/
+QQmlModelSnapshot<QVariant> QQmlVariantListModel::snapshot () const
+{
+    return QQmlModelSnapshot<QVariant> (m_items);
+}
+
+/*!
+    \details Writes the items to \a device, in the binary format of QQmlModelArchive.
+
+    The single 'qtVariant' column is of type QVariant, so each value keeps its own type.
+
+    \param device The device to write to
+    \return Whether the items were written
+
+    \sa load()
+*/
+bool QQmlVariantListModel::save (QIODevice * device) const
+{
+    QDataStream stream (device);
+    QVector<QQmlModelArchive::Column> columns;
+    columns.append (QQmlModelArchive::Column (m_roles.value (BASE_ROLE), QMetaType::QVariant));
+    if (!QQmlModelArchive::writeHeader (stream, columns, m_items.count ())) {
+        return false;
+    }
+    for (QVariantList::const_iterator it = m_items.constBegin (); it != m_items.constEnd (); ++it) {
+        QQmlModelArchive::writeValue (stream, QMetaType::QVariant, * it);
+    }
+    return (stream.status () == QDataStream::Ok);
+}
+
+/*!
+    \details Replaces the items by the ones saved in \a device by save(), with a single model reset.
+
+    \param device The device to read from
+    \return false, leaving the model untouched, if \a device doesn't hold a valid archive
+
+    \sa save()
+*/
+bool QQmlVariantListModel::load (QIODevice * device)
+{
+    QDataStream stream (device);
+    QVector<QQmlModelArchive::Column> columns;
+    qint32 rows = 0;
+    if (!QQmlModelArchive::readHeader (stream, columns, rows)) {
+        return false;
+    }
+    QVariantList itemList;
+    itemList.reserve (QQmlModelArchive::reserveHint (stream, rows, columns.count ()));
+    for (int row = 0; row < rows && stream.status () == QDataStream::Ok; ++row) {
+        if (!QQmlModelArchive::hasRowLeft (stream, columns.count ())) {
+            stream.setStatus (QDataStream::ReadPastEnd);
+            break;
+        }
+        for (int col = 0; col < columns.count (); ++col) {
+            const QVariant value = QQmlModelArchive::readValue (stream, columns.at (col).type);
+            if (col == 0) {
+                itemList.append (value);
+            }
+        }
+    }
+    if (stream.status () != QDataStream::Ok) {
+        return false;
+    }
+    if (isBatching ()) { // the batch notifies the net change
+        clear ();
+        appendList (std::move (itemList));
+    }
+    else {
+        beginResetModel ();
+        m_items.swap (itemList);
+        endResetModel ();
+        updateCounter ();
+    }
+    return true;
+}
+
 /*!
     \internal
 */
 void QQmlVariantListModel::updateCounter ()
 {
-    if (m_count != m_items.count ()) {
+    if (!isBatching () && m_count != m_items.count ()) {
         m_count = m_items.count ();
         emit countChanged (m_count);
     }
 }
+
+/*!
+    \details Starts recording mutations.
+
+    Until the matching endBatch(), row signals and \c countChanged are held and views keep seeing
+    the list as it was. Batches can be nested, only the outermost endBatch() commits.
+
+    \sa endBatch(), QQmlModelBatch
+*/
+void QQmlVariantListModel::beginBatch ()
+{
+    if (m_batchDepth++ == 0) {
+        m_committedItems = m_items;
+        m_batchActive = true;
+    }
+}
+
+/*!
+    \details Commits the mutations recorded since the matching beginBatch().
+
+    As variants have no identity, the net change is computed from the common head and tail of the
+    old and new lists : the middle is notified as one \c dataChanged for the rows present in both,
+    plus one remove or one insert for the size difference, then one \c countChanged.
+*/
+void QQmlVariantListModel::endBatch ()
+{
+    if (m_batchDepth > 0 && --m_batchDepth == 0) {
+        commitBatch ();
+    }
+}
+
+/*!
+    \details Returns true between beginBatch() and the matching endBatch().
+*/
+bool QQmlVariantListModel::isBatching () const
+{
+    return m_batchDepth > 0;
+}
+
+/*!
+    \internal
+*/
+void QQmlVariantListModel::commitBatch ()
+{
+    const int oldCount = m_committedItems.count ();
+    const int newCount = m_items.count ();
+    int head = 0;
+    while (head < oldCount && head < newCount && isSameValue (m_committedItems.at (head), m_items.at (head))) {
+        ++head;
+    }
+    int tail = 0;
+    while (tail < oldCount - head && tail < newCount - head &&
+           isSameValue (m_committedItems.at (oldCount - tail -1), m_items.at (newCount - tail -1))) {
+        ++tail;
+    }
+    const int oldMiddle = (oldCount - head - tail);
+    const int newMiddle = (newCount - head - tail);
+    if (oldMiddle > newMiddle) {
+        beginRemoveRows (NO_PARENT, head + newMiddle, head + oldMiddle -1);
+        m_committedItems.erase (m_committedItems.begin () + head + newMiddle, m_committedItems.begin () + head + oldMiddle);
+        endRemoveRows ();
+    }
+    else if (newMiddle > oldMiddle) {
+        beginInsertRows (NO_PARENT, head + oldMiddle, head + newMiddle -1);
+        m_committedItems = m_items;
+        endInsertRows ();
+    }
+    m_committedItems.clear ();
+    m_batchActive = false;
+    const int changed = qMin (oldMiddle, newMiddle);
+    if (changed > 0) {
+        notifyChanged (head, head + changed -1);
+    }
+    updateCounter ();
+}
+
+/*!
+    \internal
+    \details Whether \a first and \a second hold the same value of the same type. QVariant::operator== converts
+    across types, "1" and 1 would compare equal and the change would never reach the views.
+*/
+bool QQmlVariantListModel::isSameValue (const QVariant & first, const QVariant & second)
+{
+    return (first.userType () == second.userType () && first == second);
+}
+
+/*!
+    \internal
+    \details The list views know about, it only differs from the items during a batch.
+*/
+const QVariantList & QQmlVariantListModel::visibleItems () const
+{
+    return (m_batchActive ? m_committedItems : m_items);
+}
+
+/*!
+    \internal
+*/
+void QQmlVariantListModel::beginInsert (int first, int last)
+{
+    if (!isBatching ()) {
+        beginInsertRows (NO_PARENT, first, last);
+    }
+}
+
+/*!
+    \internal
+*/
+void QQmlVariantListModel::endInsert ()
+{
+    if (!isBatching ()) {
+        endInsertRows ();
+    }
+}
+
+/*!
+    \internal
+*/
+void QQmlVariantListModel::beginRemove (int first, int last)
+{
+    if (!isBatching ()) {
+        beginRemoveRows (NO_PARENT, first, last);
+    }
+}
+
+/*!
+    \internal
+*/
+void QQmlVariantListModel::endRemove ()
+{
+    if (!isBatching ()) {
+        endRemoveRows ();
+    }
+}
+
+/*!
+    \internal
+*/
+void QQmlVariantListModel::notifyChanged (int first, int last)
+{
+    if (!isBatching ()) {
+        emit dataChanged (QAbstractListModel::index (first, 0, NO_PARENT), QAbstractListModel::index (last, 0, NO_PARENT), QVector<int> (1, BASE_ROLE));
+    }
+}
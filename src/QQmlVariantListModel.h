@@ -2,11 +2,14 @@
 #define QQMLVARIANTLISTMODEL_H
 
 #include <QObject>
+#include <QIODevice>
 #include <QAbstractListModel>
 #include <QVariant>
 #include <QList>
+#include <QVector>
 
 #include "QQmlModelShared.h"
+#include "QQmlModelSnapshot.h"
 
 QQMLMODEL_NAMESPACE_START
 
@@ -37,8 +40,38 @@ public slots: // public API
     void insertList (int idx, const QVariantList & itemList);
     void move (int idx, int pos);
     void remove (int idx);
+    void removeRange (int first, int count);
+    QVariantList takeRange (int first, int count);
     QVariant get (int idx) const;
     QVariantList list (void) const;
+    void beginBatch (void);
+    void endBatch (void);
+    bool isBatching (void) const;
+
+public: // C++ API
+    QQmlModelSnapshot<QVariant> snapshot (void) const;
+    bool save (QIODevice * device) const;
+    bool load (QIODevice * device);
+    int pendingCount (void) const;
+    void appendList (QVariantList && itemList);
+    void prependList (QVariantList && itemList);
+    void insertList (int idx, QVariantList && itemList);
+    /** Removes every item for which predicate (item) returns true, and returns how many were removed.
+     * Each contiguous run of removed rows is notified once */
+    template<class Predicate> int removeIf (Predicate predicate) {
+        QVector<bool> flags (m_items.count (), false);
+        int ret = 0;
+        for (int row = 0; row < m_items.count (); ++row) {
+            if (predicate (m_items.at (row))) {
+                flags [row] = true;
+                ++ret;
+            }
+        }
+        if (ret > 0) {
+            removeFlagged (flags);
+        }
+        return ret;
+    }
 
 signals: // notifiers
     void countChanged (int count);
@@ -46,9 +79,24 @@ signals: // notifiers
 protected:
     void updateCounter (void);
 
+private:
+    const QVariantList & visibleItems (void) const;
+    void commitBatch (void);
+    static bool isSameValue (const QVariant & first, const QVariant & second);
+    void insertItems (int idx, QVariantList itemList, bool adopt);
+    void removeFlagged (const QVector<bool> & flags);
+    void beginInsert (int first, int last);
+    void endInsert (void);
+    void beginRemove (int first, int last);
+    void endRemove (void);
+    void notifyChanged (int first, int last);
+
 private:
     int                    m_count;
+    int                    m_batchDepth;
+    bool                   m_batchActive;
     QVariantList           m_items;
+    QVariantList           m_committedItems;
     QHash<int, QByteArray> m_roles;
 };
 
@@ -0,0 +1,153 @@
+#ifndef QQMLVECTORLISTMODEL_H
+#define QQMLVECTORLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QObject>
+#include <QVector>
+
+#include <algorithm>
+#include <utility>
+
+#include "QQmlModelShared.h"
+
+QQMLMODEL_NAMESPACE_START
+
+/**
+ * \internal
+ * Storage and QList like API of the models of values held in a QVector<T> : QQmlGadgetListModel and
+ * QQmlStructListModel. Base is the QML base class of the model, declaring the count(), isEmpty(),
+ * clear(), move(), remove() and removeRange() slots and a countChanged() signal without argument.
+ * Roles, data() and setData() are left to the model.
+ */
+template<class T, class Base> class QQmlVectorListModel : public Base
+{
+public:
+    explicit QQmlVectorListModel (QObject * parent = Q_NULLPTR)
+        : Base (parent)
+        , m_count (0)
+    { }
+    int rowCount (const QModelIndex & parent = QModelIndex ()) const Q_DECL_FINAL {
+        return (!parent.isValid () ? m_items.count () : 0);
+    }
+    typedef typename QVector<T>::const_iterator const_iterator;
+    const_iterator begin (void) const {
+        return m_items.constBegin ();
+    }
+    const_iterator end (void) const {
+        return m_items.constEnd ();
+    }
+    const_iterator constBegin (void) const {
+        return m_items.constBegin ();
+    }
+    const_iterator constEnd (void) const {
+        return m_items.constEnd ();
+    }
+
+public: // C++ API
+	/** Value at idx, idx must be valid */
+	const T & at (int idx) const {
+        return m_items.at (idx);
+    }
+	const QVector<T> & items (void) const {
+        return m_items;
+    }
+	int count (void) const Q_DECL_FINAL {
+        return m_items.count ();
+    }
+	int size (void) const {
+        return m_items.count ();
+    }
+	bool isEmpty (void) const Q_DECL_FINAL {
+        return m_items.isEmpty ();
+    }
+	void clear (void) Q_DECL_FINAL {
+        if (!m_items.isEmpty ()) {
+            this->beginResetModel ();
+            m_items.clear ();
+            updateCounter ();
+            this->endResetModel ();
+        }
+    }
+	void append (const T & value) {
+        insert (m_items.count (), value);
+    }
+	void prepend (const T & value) {
+        insert (0, value);
+    }
+	void insert (int idx, const T & value) {
+        idx = qBound (0, idx, m_items.count ());
+        this->beginInsertRows (noParent (), idx, idx);
+        m_items.insert (idx, value);
+        updateCounter ();
+        this->endInsertRows ();
+    }
+	void append (const QVector<T> & values) {
+        insert (m_items.count (), values);
+    }
+	void prepend (const QVector<T> & values) {
+        insert (0, values);
+    }
+	/** Inserts values at index position idx, with a single insert notification.
+	 * values is taken by copy, it may be items () itself */
+	void insert (int idx, QVector<T> values) {
+        if (!values.isEmpty ()) {
+            idx = qBound (0, idx, m_items.count ());
+            this->beginInsertRows (noParent (), idx, idx + values.count () -1);
+            if (m_items.isEmpty ()) {
+                m_items.swap (values);
+            }
+            else {
+                m_items.insert (idx, values.count (), T ());
+                std::copy (values.constBegin (), values.constEnd (), m_items.begin () + idx);
+            }
+            updateCounter ();
+            this->endInsertRows ();
+        }
+    }
+	void move (int idx, int pos) Q_DECL_FINAL {
+        if (idx != pos && idx >= 0 && pos >= 0 && idx < m_items.count () && pos < m_items.count ()) {
+            this->beginMoveRows (noParent (), idx, idx, noParent (), (idx < pos ? pos +1 : pos));
+            typename QVector<T>::iterator first = m_items.begin ();
+            if (idx < pos) {
+                std::rotate (first + idx, first + idx +1, first + pos +1);
+            }
+            else {
+                std::rotate (first + pos, first + idx, first + idx +1);
+            }
+            this->endMoveRows ();
+        }
+    }
+	void remove (int idx) Q_DECL_FINAL {
+        removeRange (idx, 1);
+    }
+	void removeRange (int first, int count) Q_DECL_FINAL {
+        first = qMax (first, 0);
+        count = qMin (count, m_items.count () - first);
+        if (count > 0) {
+            this->beginRemoveRows (noParent (), first, first + count -1);
+            m_items.remove (first, count);
+            updateCounter ();
+            this->endRemoveRows ();
+        }
+    }
+
+protected: // internal stuff
+    static const QModelIndex & noParent (void) {
+        static const QModelIndex ret = QModelIndex ();
+        return ret;
+    }
+    inline void updateCounter (void) {
+        if (m_count != m_items.count ()) {
+            m_count = m_items.count ();
+            emit this->countChanged ();
+        }
+    }
+
+protected: // data members
+    int        m_count;
+    QVector<T> m_items;
+};
+
+QQMLMODEL_NAMESPACE_END
+
+#endif // QQMLVECTORLISTMODEL_H